@@ -44,6 +44,7 @@ namespace hlscnn {
   /*********************************************************/
   enum ConfigRegId {
     // Unused configuration registers.
+    // ConfigReg1 is AccelConvDescAddr with ModelConfig::conv_desc_chain
     ConfigReg1,
     ConfigReg2,
     ConfigReg3,
@@ -78,6 +79,16 @@ namespace hlscnn {
     NumCfgRegisters
   };
 
+  // addr of the first conv layer descriptor in the soc memory, writing it
+  // starts the descriptor chain (ModelConfig::conv_desc_chain)
+  const int AccelConvDescAddr = ConfigReg1;
+
+  // With ModelConfig::cfg_wide_write, a write to CFG_REG_WIDE_BASE_ADDR + 16*n
+  // sets the 4 config registers 4n..4n+3 from the 4 32-bit slices of the beat
+  // (register 4n in the low bits). The trigger registers are not written this
+  // way, they keep their own 32-bit writes.
+  #define CFG_REG_WIDE_BASE_ADDR 0x2000
+
   /*********************************************************/
   // define config state names
   /*********************************************************/
@@ -162,6 +173,11 @@ namespace hlscnn {
   // ------------------------------------------------------
   // |  31-24 |    23:16      |    15-8     |     7-0     |
   // ------------------------------------------------------
+  //
+  // With ModelConfig::conv_fused_pool, bits 23-22 hold the pooling window size
+  // (2 or 3, 0/1 for no pooling) and bit 24 selects average pooling.
+  // With ModelConfig::conv_act_spad1, bit 25 selects spad1 as the activation
+  // source.
   #define CFG_REG_ACCEL_KERNEL_SIZE_CFG "cfg_reg_accel_kernel_size_cfg"
 
   // Layout of the AccelConvChannelConfig register.
@@ -176,8 +192,29 @@ namespace hlscnn {
   // ------------------------------------------------------------------------------------------------------------------
   // |  31-24|    22     |  21-19              |     18                            |         17         |     16   |     15-0            |
   // ------------------------------------------------------------------------------------------------------------------
+  //
+  // With ModelConfig::conv_grouped, bits 31-28 hold log2 of the number of groups
+  // (0: ungrouped, up to 2^15 groups). The input channels and the filters are
+  // split evenly over the groups and each filter only reduces over the channels
+  // of its group, e.g. a depthwise layer of C channels sets log2(C).
   #define CFG_REG_ACCEL_CONV_CHANNEL_CFG "cfg_reg_accel_conv_channel_cfg"
 
+  // Layout of a conv layer descriptor (ModelConfig::conv_desc_chain), 48
+  // bytes at a 16-byte aligned addr of the soc memory, one 32-bit word each:
+  //
+  // |  0  |   act base   |  4  | weight base  |  8  | output base  |
+  // |  12 |  input size  |  16 | output size  |  20 | kernel size  |
+  // |  24 | channel cfg  |  28 | next desc addr (0: last layer)    |
+  // |  32 | weight soc addr  |  36 | weight length (16-byte lines) |
+  // |  40 | reserved         |  44 | reserved                      |
+  //
+  // The fields up to 28 have the layouts of the config registers above. A
+  // non-zero weight length copies the layer weights from the weight soc addr
+  // to spad0 offset 0 (the weight base with ModelConfig::spad_double_buffer),
+  // where the conv children read them, through the SPAD child before the
+  // layer is launched.
+  #define CONV_DESC_BYTEWIDTH 48
+
 
 
   // -------------------------------------------
@@ -202,9 +239,12 @@ namespace hlscnn {
   // Use this register in conjunction with the AccelBiasActivationConfig
   // register.
   //
-  // |  Unused  |   Bias   |
-  // -----------------------
-  // |  31-16   |   15-0   |
+  // Pool size is the rows/cols (and the stride) of the pooling window, 0 pools
+  // the whole input map into one vector per channel block.
+  //
+  // |  Unused  | Avg pool | Pool size |   Bias   |
+  // ----------------------------------------------
+  // |  31-21   |    20    |   19-16   |   15-0   |
   // ----------------------------------------------
   #define CFG_REG_ACCEL_REDUCTION_BIAS_CONFIG "cfg_reg_accel_reduction_bias_config"
 
@@ -114,6 +114,21 @@ namespace hlscnn {
 #define CONV_CHAN_BIAS "conv_chan_bias"
 #define CONV_CHAN_BIAS_BITWIDTH WEIGHT_TOTAL_BITWIDTH
 
+// grouped conv: log2 of the number of groups, 0 for ungrouped conv
+#define CONV_GROUP_NUM_LOG2 "conv_group_num_log2"
+#define CONV_GROUP_NUM_LOG2_BITWIDTH 4
+
+// fused pooling of the conv outputs: window size (0/1 for no pooling) and mode
+#define CONV_POOL_SIZE "conv_pool_size"
+#define CONV_POOL_SIZE_BITWIDTH 2
+
+#define CONV_POOL_AVG "conv_pool_avg"
+#define CONV_POOL_AVG_BITWIDTH CONV_BOOL_WIDTH
+
+// read the activations from spad1 instead of the soc memory
+#define CONV_ACT_SRC_SPAD1 "conv_act_src_spad1"
+#define CONV_ACT_SRC_SPAD1_BITWIDTH CONV_BOOL_WIDTH
+
 // 08142020: model multiple activation fetch request in activation fetching
 #define CONV_BURST_LENGTH 8
 
@@ -45,6 +45,11 @@ namespace hlscnn {
 #define FC_BOOL_WIDTH 1
 #define FC_BATCH_WIDTH 3
 
+// largest batch sharing one weight fetch, FC_BATCH_SIZE holds batch size - 1
+#define FC_MAC_BATCH 8
+// weights (and activations) of one row read per MAC step
+#define FC_MAC_VECTOR_SIZE 8
+
 #define FC_WEIGHT_BASE "fc_weight_base"
 #define FC_WEIGHT_BASE_BITWIDTH FC_ADDR_WIDTH
 
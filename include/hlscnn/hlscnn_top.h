@@ -31,6 +31,7 @@
 #include <string>
 #include <ilang/util/log.h>
 
+#include <hlscnn/model_config.h>
 #include <hlscnn/top_config.h>
 #include <hlscnn/common_config.h>
 #include <hlscnn/config_reg.h>
@@ -45,29 +46,63 @@ namespace ilang {
 
 namespace hlscnn {
 
-Ila GetHlscnnIla(const std::string& model_name = "hlscnn");
+Ila GetHlscnnIla(const std::string& model_name = "hlscnn",
+                 const ModelConfig& cfg = ModelConfig());
 
-void DefineTopIO(Ila& m);
+void DefineTopIO(Ila& m, const ModelConfig& cfg);
 
 void DefineConfigReg(Ila& m);
 void DefineFCParam(Ila& m);
-void DefineConvParam(Ila& m);
-void DefineReduceParam(Ila& m);
+void DefineConvParam(Ila& m, const ModelConfig& cfg);
+void DefineReduceParam(Ila& m, const ModelConfig& cfg);
 
-void DefineArchState(Ila& m);
-void DefineInternalState(Ila& m);
+void DefineArchState(Ila& m, const ModelConfig& cfg);
+void DefineInternalState(Ila& m, const ModelConfig& cfg);
 
 void DefineInitCond(Ila& m);
 
-void DefineConfigInstr(Ila& m);
-void DefineSPADInstr(Ila& m);
-void DefineAccelConvTrigger(Ila& m);
+void DefineConfigInstr(Ila& m, const ModelConfig& cfg);
+void DefineSPADInstr(Ila& m, const ModelConfig& cfg);
+void DefineAccelConvTrigger(Ila& m, const ModelConfig& cfg);
+// latch the conv params of a layer and start the conv child from instr
+void SetConvTriggerUpdate(InstrRef& instr, Ila& m, const ModelConfig& cfg,
+                          const ExprRef& act_base_addr,
+                          const ExprRef& weight_base_addr,
+                          const ExprRef& output_base_addr,
+                          const ExprRef& input_size_config,
+                          const ExprRef& output_size_config,
+                          const ExprRef& kernel_size_config,
+                          const ExprRef& channel_config);
 
-void DefineVirMemInstr(Ila& m);
+void DefineVirMemInstr(Ila& m, const ModelConfig& cfg);
 // child instructions
-void DefineAXIMasterChild(Ila& m);
-void DefineAccelConvChild(Ila& m);
-void DefineSPADInstrChild(Ila& m);
+void DefineAXIMasterChild(Ila& m, const ModelConfig& cfg);
+void DefineAccelConvChild(Ila& m, const ModelConfig& cfg);
+void DefineAccelConvChildCoarse(Ila& m, const ModelConfig& cfg);
+void DefineAccelFCChild(Ila& m);
+void DefineAccelReductionChild(Ila& m);
+void DefineAccelConvDescChild(Ila& m, const ModelConfig& cfg);
+void DefineAccelConvCmdQueueChild(Ila& m, const ModelConfig& cfg);
+void DefineSPADInstrChild(Ila& m, const ModelConfig& cfg);
+void DefineSPADWriteBackChild(Ila& m, const ModelConfig& cfg);
+
+// start the spad1 write-back child of the region at spad_addr from instr when
+// is_start holds
+void SetSPADWriteBackStart(InstrRef& instr, Ila& m, const ExprRef& is_start,
+                           const ExprRef& spad_addr);
+
+// AXI master read requests (ModelConfig::axi_master_outstanding)
+// whether a request slot is free
+ExprRef AXIMasterRdReqReady(const Ila& m, const ModelConfig& cfg);
+// issue a read request of the 16-byte beat at addr of the soc memory from instr
+void SetAXIMasterRdReq(InstrRef& instr, Ila& m, const ModelConfig& cfg,
+                       const ExprRef& addr, const int& src);
+// whether the oldest response is valid and belongs to src
+ExprRef AXIMasterRdRespValid(const Ila& m, const ModelConfig& cfg, const int& src);
+// the beat of the oldest response
+ExprRef AXIMasterRdRespData(const Ila& m, const ModelConfig& cfg);
+// consume the oldest response from instr
+void SetAXIMasterRdResp(InstrRef& instr, Ila& m, const ModelConfig& cfg);
 
 }
 };
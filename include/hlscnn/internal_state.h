@@ -28,6 +28,8 @@
 #define _INTERNAL_STATE_H__
 
 #include <hlscnn/conv_param.h>
+#include <hlscnn/reduction_param.h>
+#include <hlscnn/fc_param.h>
 #include <hlscnn/common_config.h>
 #include <hlscnn/config_reg.h>
 
@@ -54,6 +56,30 @@ namespace hlscnn {
 #define MASTER_AXI_CHILD_STATE_SPAD1_RD 2
 #define MASTER_AXI_CHILD_STATE_ACT_RD 3
 
+// read request queue of the AXI master child (ModelConfig::axi_master_outstanding)
+// the slots form a ring, requests are issued at the tail and their responses
+// are returned in order from the head
+#define AXI_MASTER_RD_HEAD "axi_master_rd_head"
+#define AXI_MASTER_RD_TAIL "axi_master_rd_tail"
+#define AXI_MASTER_RD_PTR_BITWIDTH 8
+// number of the issued and not yet consumed requests
+#define AXI_MASTER_RD_CNT "axi_master_rd_cnt"
+#define AXI_MASTER_RD_CNT_BITWIDTH 9
+
+// per slot states, GetStateName(AXI_MASTER_RD_*, slot)
+// the 16-byte beat of the request (byte 0 in the low bits)
+#define AXI_MASTER_RD_DATA "axi_master_rd_data"
+#define AXI_MASTER_RD_DATA_BITWIDTH (8*NIC_MEM_ELEM_BYTEWIDTH)
+// remaining latency of the request, the response is valid at 0
+#define AXI_MASTER_RD_LAT "axi_master_rd_lat"
+#define AXI_MASTER_RD_LAT_BITWIDTH 8
+// the client of the request
+#define AXI_MASTER_RD_SRC "axi_master_rd_src"
+#define AXI_MASTER_RD_SRC_BITWIDTH 1
+
+#define AXI_MASTER_RD_SRC_SPAD 0
+#define AXI_MASTER_RD_SRC_CONV_ACT 1
+
 // #define ACCEL_MASTER_AXI_CHILD_RD_RECV_VALID_FLAG                                     \
 //   "accel_master_axi_child_rd_recv_valid_flag"
 // #define ACCEL_MASTER_AXI_CHILD_RD_RECV_VALID_FLAG_BITWIDTH 1
@@ -92,6 +118,8 @@ namespace hlscnn {
 #define CONV_CHILD_STATE_FETCH_OUT_ACT 13
 #define CONV_CHILD_STATE_BIAS_RELU 14
 #define CONV_CHILD_STATE_OUT 15
+// FSM state filling the weight cache at the start of each filter/channel block
+#define CONV_CHILD_STATE_WEIGHT_CACHE_FILL 19
 
 #define CONV_CHILD_STATE_DONE 31
 
@@ -118,15 +146,22 @@ namespace hlscnn {
 #define CONV_CHILD_KERNEL_ROW_ID "conv_child_kernel_row_id"
 #define CONV_CHILD_KERNEL_ROW_ID_BITWIDTH CONV_KERNEL_SIZE_T
 
+// live kernel window of the current input pixel (analytic kernel bounds)
+#define CONV_CHILD_KERNEL_ROW_LAST "conv_child_kernel_row_last"
+#define CONV_CHILD_KERNEL_ROW_LAST_BITWIDTH CONV_KERNEL_SIZE_T
+
+#define CONV_CHILD_KERNEL_COL_FIRST "conv_child_kernel_col_first"
+#define CONV_CHILD_KERNEL_COL_FIRST_BITWIDTH CONV_KERNEL_SIZE_T
+
+#define CONV_CHILD_KERNEL_COL_LAST "conv_child_kernel_col_last"
+#define CONV_CHILD_KERNEL_COL_LAST_BITWIDTH CONV_KERNEL_SIZE_T
+
+// weight cache of the current filter/channel block, one entry per kernel
+// position (k_row*kernel_cols + k_col) holding the weight bytes of the vector
+#define CONV_CHILD_WEIGHT_CACHE "conv_child_weight_cache"
+#define CONV_CHILD_WEIGHT_CACHE_ADDR_BITWIDTH 16
+
 #define CONV_CHILD_ACT_ARRAY "conv_child_act_array"
-#define CONV_CHILD_ACT_ARRAY_0 "conv_child_act_array_0"
-#define CONV_CHILD_ACT_ARRAY_1 "conv_child_act_array_1"
-#define CONV_CHILD_ACT_ARRAY_2 "conv_child_act_array_2"
-#define CONV_CHILD_ACT_ARRAY_3 "conv_child_act_array_3"
-#define CONV_CHILD_ACT_ARRAY_4 "conv_child_act_array_4"
-#define CONV_CHILD_ACT_ARRAY_5 "conv_child_act_array_5"
-#define CONV_CHILD_ACT_ARRAY_6 "conv_child_act_array_6"
-#define CONV_CHILD_ACT_ARRAY_7 "conv_child_act_array_7"
 
 #define CONV_CHILD_ACT_ARRAY_BITWIDTH ACT_TOTAL_BITWIDTH
 
@@ -134,38 +169,14 @@ namespace hlscnn {
 #define CONV_CHILD_WEIGHT_ADDR_BITWIDTH TOP_SLAVE_ADDR_IN_BITWIDTH
 
 #define CONV_CHILD_WEIGHT_ARRAY "conv_child_weight_array"
-#define CONV_CHILD_WEIGHT_ARRAY_0 "conv_child_weight_array_0"
-#define CONV_CHILD_WEIGHT_ARRAY_1 "conv_child_weight_array_1"
-#define CONV_CHILD_WEIGHT_ARRAY_2 "conv_child_weight_array_2"
-#define CONV_CHILD_WEIGHT_ARRAY_3 "conv_child_weight_array_3"
-#define CONV_CHILD_WEIGHT_ARRAY_4 "conv_child_weight_array_4"
-#define CONV_CHILD_WEIGHT_ARRAY_5 "conv_child_weight_array_5"
-#define CONV_CHILD_WEIGHT_ARRAY_6 "conv_child_weight_array_6"
-#define CONV_CHILD_WEIGHT_ARRAY_7 "conv_child_weight_array_7"
 
 #define CONV_CHILD_WEIGHT_ARRAY_BITWIDTH WEIGHT_TOTAL_BITWIDTH
 
 #define CONV_CHILD_O_ACT_ARRAY "conv_child_o_act_array"
-#define CONV_CHILD_O_ACT_ARRAY_0 "conv_child_o_act_array_0"
-#define CONV_CHILD_O_ACT_ARRAY_1 "conv_child_o_act_array_1"
-#define CONV_CHILD_O_ACT_ARRAY_2 "conv_child_o_act_array_2"
-#define CONV_CHILD_O_ACT_ARRAY_3 "conv_child_o_act_array_3"
-#define CONV_CHILD_O_ACT_ARRAY_4 "conv_child_o_act_array_4"
-#define CONV_CHILD_O_ACT_ARRAY_5 "conv_child_o_act_array_5"
-#define CONV_CHILD_O_ACT_ARRAY_6 "conv_child_o_act_array_6"
-#define CONV_CHILD_O_ACT_ARRAY_7 "conv_child_o_act_array_7"
 
 #define CONV_CHILD_O_ACT_ARRAY_BITWIDTH ACT_TOTAL_BITWIDTH
 
 #define CONV_CHILD_OUT_ARRAY "conv_child_out_array"
-#define CONV_CHILD_OUT_ARRAY_0 "conv_child_out_array_0"
-#define CONV_CHILD_OUT_ARRAY_1 "conv_child_out_array_1"
-#define CONV_CHILD_OUT_ARRAY_2 "conv_child_out_array_2"
-#define CONV_CHILD_OUT_ARRAY_3 "conv_child_out_array_3"
-#define CONV_CHILD_OUT_ARRAY_4 "conv_child_out_array_4"
-#define CONV_CHILD_OUT_ARRAY_5 "conv_child_out_array_5"
-#define CONV_CHILD_OUT_ARRAY_6 "conv_child_out_array_6"
-#define CONV_CHILD_OUT_ARRAY_7 "conv_child_out_array_7"
 
 #define CONV_CHILD_OUT_ARRAY_BITWIDTH ACT_TOTAL_BITWIDTH
 
@@ -182,6 +193,116 @@ namespace hlscnn {
 #define CONV_CHILD_ACT_FETCH_CNTR "conv_child_act_fetch_cntr"
 #define CONV_CHILD_ACT_FETCH_CNTR_BITWIDTH CONV_ROW_SIZE_T
 
+// act vectors of the burst requested through the AXI master child
+// (ModelConfig::axi_master_outstanding)
+#define CONV_CHILD_ACT_ISSUE_CNTR "conv_child_act_issue_cntr"
+#define CONV_CHILD_ACT_ISSUE_CNTR_BITWIDTH CONV_CHILD_ACT_FETCH_CNTR_BITWIDTH
+
+// per-layer counters of the zero activation skipping: activation vectors
+// fetched and the all-zero ones skipped without the weight/datapath loop
+#define CONV_CHILD_ACT_VEC_CNTR "conv_child_act_vec_cntr"
+#define CONV_CHILD_ACT_VEC_CNTR_BITWIDTH 32
+
+#define CONV_CHILD_ZERO_SKIP_CNTR "conv_child_zero_skip_cntr"
+#define CONV_CHILD_ZERO_SKIP_CNTR_BITWIDTH 32
+
+/////////////////////////////////////////////
+//      interanl states of coarse-grained Conv
+/////////////////////////////////////////////
+// the coarse-grained child shares the valid flag and the FSM state with the
+// fine-grained child, only one of them is valid for a given kernel size
+#define CONV_CHILD_STATE_COARSE_OUT_VEC 18
+
+// largest kernel rows/cols unrolled in one coarse-grained instruction
+#define CONV_COARSE_MAX_KERNEL_SIZE 7
+
+#define CONV_COARSE_FILTER_ID "conv_coarse_filter_id"
+#define CONV_COARSE_FILTER_ID_BITWIDTH CONV_FILTER_SIZE_T
+
+#define CONV_COARSE_CHAN_BLOCK_ID "conv_coarse_chan_block_id"
+#define CONV_COARSE_CHAN_BLOCK_ID_BITWIDTH CONV_CHANNEL_SIZE_T
+
+#define CONV_COARSE_OUT_ROW_ID "conv_coarse_out_row_id"
+#define CONV_COARSE_OUT_ROW_ID_BITWIDTH CONV_ROW_SIZE_T
+
+#define CONV_COARSE_OUT_COL_ID "conv_coarse_out_col_id"
+#define CONV_COARSE_OUT_COL_ID_BITWIDTH CONV_ROW_SIZE_T
+
+// output-stationary mode: MAC sum of the current output vector over the
+// channel blocks visited so far
+#define CONV_COARSE_OUT_PSUM "conv_coarse_out_psum"
+#define CONV_COARSE_OUT_PSUM_BITWIDTH PSUM_TOTAL_BITWIDTH
+
+// fused pooling: psum accumulator of the window of each pooled col, the
+// outputs of a window arrive over pool_size rows of the output map
+#define CONV_COARSE_POOL_ACC "conv_coarse_pool_acc"
+#define CONV_COARSE_POOL_ACC_ADDR_BITWIDTH CONV_ROW_SIZE_T
+#define CONV_COARSE_POOL_ACC_DATA_BITWIDTH PSUM_TOTAL_BITWIDTH
+
+
+/////////////////////////////////////////////
+//      interanl states of FC
+/////////////////////////////////////////////
+#define ACCEL_FC_CHILD_VALID 1
+#define ACCEL_FC_CHILD_INVALID 0
+
+#define ACCEL_FC_CHILD_VALID_FLAG "accel_fc_child_valid_flag"
+#define ACCEL_FC_CHILD_VALID_FLAG_BITWIDTH 1
+
+#define ACCEL_FC_CHILD_STATE "accel_fc_child_state"
+#define ACCEL_FC_CHILD_STATE_BITWIDTH 2
+
+#define FC_CHILD_STATE_IDLE 0
+#define FC_CHILD_STATE_MAC 1
+#define FC_CHILD_STATE_DONE 3
+
+#define FC_CHILD_ROW_ID "fc_child_row_id"
+#define FC_CHILD_ROW_ID_BITWIDTH FC_NUM_ROWS_BITWIDTH
+
+#define FC_CHILD_COL_BLOCK_ID "fc_child_col_block_id"
+#define FC_CHILD_COL_BLOCK_ID_BITWIDTH FC_NUM_COLS_BITWIDTH
+
+// MAC sum of the current row for each activation vector of the batch
+#define FC_CHILD_PSUM_ARRAY "fc_child_psum_array"
+#define FC_CHILD_PSUM_ARRAY_BITWIDTH PSUM_TOTAL_BITWIDTH
+
+/////////////////////////////////////////////
+//      interanl states of Reduction
+/////////////////////////////////////////////
+#define ACCEL_REDUCTION_CHILD_VALID 1
+#define ACCEL_REDUCTION_CHILD_INVALID 0
+
+#define ACCEL_REDUCTION_CHILD_VALID_FLAG "accel_reduction_child_valid_flag"
+#define ACCEL_REDUCTION_CHILD_VALID_FLAG_BITWIDTH 1
+
+#define ACCEL_REDUCTION_CHILD_STATE "accel_reduction_child_state"
+#define ACCEL_REDUCTION_CHILD_STATE_BITWIDTH 2
+
+#define REDUCTION_CHILD_STATE_IDLE 0
+#define REDUCTION_CHILD_STATE_ACCUM 1
+#define REDUCTION_CHILD_STATE_OUT 2
+#define REDUCTION_CHILD_STATE_DONE 3
+
+#define REDUCTION_CHILD_CHAN_BLOCK_ID "reduction_child_chan_block_id"
+#define REDUCTION_CHILD_CHAN_BLOCK_ID_BITWIDTH REDUCTION_NUM_CHAN_BITWIDTH
+
+#define REDUCTION_CHILD_OUT_ROW_ID "reduction_child_out_row_id"
+#define REDUCTION_CHILD_OUT_ROW_ID_BITWIDTH REDUCTION_NUM_ROW_BITWIDTH
+
+#define REDUCTION_CHILD_OUT_COL_ID "reduction_child_out_col_id"
+#define REDUCTION_CHILD_OUT_COL_ID_BITWIDTH REDUCTION_NUM_ROW_BITWIDTH
+
+// position in the pooling window of the current output vector
+#define REDUCTION_CHILD_WIN_ROW_ID "reduction_child_win_row_id"
+#define REDUCTION_CHILD_WIN_ROW_ID_BITWIDTH REDUCTION_NUM_ROW_BITWIDTH
+
+#define REDUCTION_CHILD_WIN_COL_ID "reduction_child_win_col_id"
+#define REDUCTION_CHILD_WIN_COL_ID_BITWIDTH REDUCTION_NUM_ROW_BITWIDTH
+
+// per-lane max/sum of the pooling window so far
+#define REDUCTION_CHILD_ACC_ARRAY "reduction_child_acc_array"
+#define REDUCTION_CHILD_ACC_ARRAY_BITWIDTH PSUM_TOTAL_BITWIDTH
+
 
 //////////////////////////////////////////////////////////
 // internal states for SPAD child instructions 
@@ -193,10 +314,79 @@ namespace hlscnn {
 #define SPAD_RD_WR_CNTR "spad_rd_wr_cntr"
 #define SPAD_RD_WR_CNTR_BITWIDTH CFG_REG_BITWIDTH
 
+// counter for the issued AXI master read requests (ModelConfig::axi_master_outstanding)
+#define SPAD_RD_REQ_CNTR "spad_rd_req_cntr"
+#define SPAD_RD_REQ_CNTR_BITWIDTH CFG_REG_BITWIDTH
+
 // reg for distinguish spad read/write on spad0 or spad1
 #define SPAD_CHILD_TARGET "spad_child_target"
 #define SPAD_CHILD_TARGET_BITWIDTH 1
 
+// spad offset of the transfer, latched at the start with
+// ModelConfig::conv_desc_chain, whose weight DMA has no host write addr
+#define SPAD_CHILD_SPAD_ADDR "spad_child_spad_addr"
+#define SPAD_CHILD_SPAD_ADDR_BITWIDTH CFG_REG_BITWIDTH
+
+// half of spad0 (weights) and of spad1 (outputs) owned by the conv child
+// while it runs, latched when the layer starts (ModelConfig::spad_double_buffer)
+#define SPAD0_CONV_HALF "spad0_conv_half"
+#define SPAD1_CONV_HALF "spad1_conv_half"
+#define SPAD_CONV_HALF_BITWIDTH 1
+// the spad1 half of the activations, owned too when the layer reads them from
+// spad1 (ModelConfig::conv_act_spad1)
+#define SPAD1_CONV_ACT_HALF "spad1_conv_act_half"
+
+//////////////////////////////////////////////////////////
+// internal states for the conv descriptor child
+//////////////////////////////////////////////////////////
+#define CONV_DESC_CHILD_VALID_FLAG "conv_desc_child_valid_flag"
+#define CONV_DESC_CHILD_VALID_FLAG_BITWIDTH 1
+
+// soc memory addr of the next layer descriptor
+#define CONV_DESC_ADDR "conv_desc_addr"
+#define CONV_DESC_ADDR_BITWIDTH CFG_REG_BITWIDTH
+
+// the weight DMA of the current descriptor is started before its layer
+#define CONV_DESC_STATE "conv_desc_state"
+#define CONV_DESC_STATE_BITWIDTH 1
+
+#define CONV_DESC_STATE_WT_DMA 0
+#define CONV_DESC_STATE_LAUNCH 1
+
+//////////////////////////////////////////////////////////
+// internal states for the spad1 write-back child
+//////////////////////////////////////////////////////////
+#define SPAD_WB_CHILD_VALID_FLAG "spad_wb_child_valid_flag"
+#define SPAD_WB_CHILD_VALID_FLAG_BITWIDTH 1
+
+// counter for the written 16-byte lines
+#define SPAD_WB_CNTR "spad_wb_cntr"
+#define SPAD_WB_CNTR_BITWIDTH CFG_REG_BITWIDTH
+
+// spad1 offset of the written region, latched from AccelSpadCFG
+#define SPAD_WB_SPAD_ADDR "spad_wb_spad_addr"
+#define SPAD_WB_SPAD_ADDR_BITWIDTH CFG_REG_BITWIDTH
+
+// soc memory addr and number of 16-byte lines of the write-back, latched from
+// CFG_REG_SOC_MEM_BASE_ADDR/CFG_REG_SOC_MEM_RD_WR_LENGTH when it starts, as the
+// host may program the next SPAD transfer meanwhile
+#define SPAD_WB_SOC_ADDR "spad_wb_soc_addr"
+#define SPAD_WB_SOC_ADDR_BITWIDTH CFG_REG_BITWIDTH
+#define SPAD_WB_LENGTH "spad_wb_length"
+#define SPAD_WB_LENGTH_BITWIDTH CFG_REG_BITWIDTH
+
+//////////////////////////////////////////////////////////
+// internal states for the conv command queue
+//////////////////////////////////////////////////////////
+// number of the queued conv triggers
+#define CONV_CMDQ_CNT "conv_cmdq_cnt"
+#define CONV_CMDQ_CNT_BITWIDTH 8
+
+// queue entries (GetStateName(CONV_CMDQ_ENTRY, i), entry 0 is the head), the
+// 7 conv config registers of a trigger with the act base addr in the low bits
+#define CONV_CMDQ_ENTRY "conv_cmdq_entry"
+#define CONV_CMDQ_ENTRY_BITWIDTH (7*CFG_REG_BITWIDTH)
+
 
 
 
@@ -0,0 +1,236 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: model_config.h
+
+// This file contains the options that are fixed when the ILA model is built
+// (passed to GetHlscnnIla). The default values give the original model.
+
+#ifndef MODEL_CONFIG_H__
+#define MODEL_CONFIG_H__
+
+#include <hlscnn/common_config.h>
+
+namespace ilang {
+namespace hlscnn {
+
+struct ModelConfig {
+  // Number of lanes of the conv datapath, i.e. the elements of the act/weight/
+  // output vectors of the fine-grained conv child, which is also the input
+  // channel block size of the activation and weight layouts. A vector of
+  // activations must fill whole 16-byte lines, i.e. conv_lanes*conv_act_bits
+  // must be a multiple of 128 (a multiple of CONV_VECTOR_SIZE with 16-bit
+  // activations).
+  int conv_lanes = CONV_VECTOR_SIZE;
+
+  // Element bitwidth profile of the fine-grained conv child datapath:
+  // - conv_weight_bits: the weight operand of the MACs (at least 8), the 8-bit
+  //   spad0 weights are placed in its top bits
+  // - conv_act_bits: the activations (8 or 16) in the soc memory, in spad1 and
+  //   in the child arrays, and the stored outputs
+  // - conv_psum_bits: the MAC psum
+  // The default profile is the original 16/16/32 one, any other profile gets
+  // uninterpreted functions of its own sorts (ConvDpFuncs).
+  int conv_weight_bits = WEIGHT_TOTAL_BITWIDTH;
+  int conv_act_bits = ACT_TOTAL_BITWIDTH;
+  int conv_psum_bits = PSUM_TOTAL_BITWIDTH;
+
+  // Use the coarse-grained conv child, which finishes one output vector (for
+  // one input channel block) per instruction instead of stepping through the
+  // per-MAC FSM. Layers with kernels larger than CONV_COARSE_MAX_KERNEL_SIZE
+  // still fall back to the fine-grained child.
+  bool conv_child_coarse = false;
+
+  // Compute the whole conv layer in ACCEL_CONV_TRIGGER through the ConvLayer
+  // uninterpreted function, without any of the conv child FSM states.
+  bool conv_layer_uf = false;
+
+  // Replace send_dp, dp_mac_psum, fetch_act_spad1, dp_bias_relu and output of
+  // the fine-grained conv child by a single fused datapath instruction.
+  bool conv_fused_datapath = false;
+
+  // Compute the live kernel row/col range of each input pixel when its weight
+  // loop starts, and step only through the in-bound kernel positions instead
+  // of visiting every position through accel_conv_check_out_of_bound.
+  bool conv_analytic_kernel_bounds = false;
+
+  // Keep the un-rounded MAC sum of the current output vector in a 32-bit
+  // register across kernel positions and input channel blocks of the
+  // coarse-grained conv child, and read/write spad1 only once per output
+  // vector. The result is rounded once instead of once per MAC, thus it is
+  // not bit-exact with the fine-grained child. Requires conv_child_coarse.
+  bool conv_output_stationary = false;
+
+  // Step the output rows/cols of the coarse-grained conv child by the kernel
+  // stride, starting from (kernel_size/2) % stride. The other outputs don't
+  // receive any (input pixel, kernel) pair, thus strided layers take about
+  // 1/(row_stride*col_stride) of the steps. Requires conv_child_coarse.
+  bool conv_coarse_stride_loop = false;
+
+  // Copy the kernel_rows*kernel_cols weight vectors of the current filter and
+  // input channel block from spad0 into a child weight cache when the pair
+  // starts, and read the weights of each MAC from the cache afterwards.
+  bool conv_weight_cache = false;
+
+  // Skip the kernel/datapath loop of an all-zero activation vector in the
+  // fine-grained conv child, unless it resets the accumulation (first channel
+  // block without en_accum) or belongs to the last channel block, whose MAC
+  // steps write the final output vectors as the non-skipping child does. The
+  // conv_child_act_vec_cntr and conv_child_zero_skip_cntr states count the
+  // fetched and the skipped vectors of the layer.
+  bool conv_zero_skip = false;
+
+  // Compute conv_lanes filters per pass of the fine-grained conv child:
+  // filter group g produces filters g*lanes..g*lanes+lanes-1 in the lanes of
+  // one output vector, reusing each fetched activation vector for all of them.
+  // The filter loop runs over the ceil(CONV_OFILTER_IDX/lanes) groups and the
+  // output vector of group g is stored where filter g was stored before.
+  bool conv_multi_filter = false;
+
+  // Support grouped (and depthwise) conv: the channel config gives log2 of the
+  // number of groups, and each filter of the fine-grained conv child only
+  // fetches the channel blocks and stores the weights of its own group's
+  // channels. A group smaller than a channel block (e.g. depthwise conv, one
+  // channel per group) has its weights in its own lanes of the block and zero
+  // weights in the others. A layer whose channels or filters don't split
+  // evenly over the groups, or whose groups aren't whole channel blocks or a
+  // divisor of the block size, runs ungrouped.
+  bool conv_grouped = false;
+
+  // Add the reduction (pooling) child started by AccelReductionTrigger, with
+  // the pool size/average/bias enable fields of the reduction config and the
+  // reduction config register writes. The child reads and writes 16-bit
+  // activations in spad1, thus it requires the default conv_act_bits.
+  bool reduction_child = false;
+
+  // Add the FC child started by AccelStartFlagReg, with the FC config register
+  // writes. Each weight vector read from the soc memory is MAC'd with all the
+  // FC_BATCH_SIZE+1 activation vectors of the batch in spad0, and the outputs
+  // are written to spad1 at the same offset.
+  bool fc_child = false;
+
+  // Pool the outputs of the coarse-grained conv child as they are finished
+  // (2x2 or 3x3 non-overlapping windows, max or average, set in the kernel
+  // size config) and write only the pooled map, (rows/P) x (cols/P) per
+  // filter, to spad1. The windows of the current pooled row are reduced in
+  // 32-bit psum accumulators and rounded once at their last output. Requires
+  // conv_output_stationary without conv_coarse_stride_loop; layers falling
+  // back to the fine-grained child (kernels above CONV_COARSE_MAX_KERNEL_SIZE)
+  // are written unpooled.
+  bool conv_fused_pool = false;
+
+  // Declare the scratchpads and the virtual soc memory with
+  // NIC_MEM_ELEM_BYTEWIDTH-byte words instead of bytes. The 16-byte transfers
+  // become a single Load/Store and only the element accesses extract sub-words.
+  // The vectors must be word-aligned, as they are in the hardware.
+  bool mem_word_level = false;
+
+  // Copy the whole CFG_REG_SOC_MEM_RD_WR_LENGTH x 16 bytes of a SPAD child
+  // transfer from the virtual soc memory into the scratchpad in a single child
+  // instruction, through the SpadBulkCopy function, instead of 16 bytes per
+  // instruction. Requires byte-level memories.
+  bool spad_bulk_dma = false;
+
+  // Bytes of the burst data input of the slave interface (0: no burst input).
+  // With top_slave_if_burst set, VIR_MEM_BURST_WR writes the first
+  // top_slave_burst_len 16-byte beats of top_slave_burst_data_in into the
+  // virtual soc memory in one instruction. Must be a multiple of
+  // NIC_MEM_ELEM_BYTEWIDTH.
+  int vir_mem_burst_bytes = 0;
+
+  // Add the top_slave_rd_len input: a spad read with more than one line
+  // copies top_slave_rd_len 16-byte spad lines (8 activations each) into the
+  // virtual output memory in one instruction, through the SpadBulkRead
+  // function. Requires byte-level memories.
+  bool spad_bulk_readback = false;
+
+  // Add the spad1 write-back child, the AXI master write counterpart of the
+  // SPAD child: it copies CFG_REG_SOC_MEM_RD_WR_LENGTH 16-byte lines of spad1
+  // to the soc memory at CFG_REG_SOC_MEM_BASE_ADDR. Writing the spad1 offset of
+  // the region into AccelSpadCFG starts it, and so does a conv layer with
+  // ENABLE_WB when it finishes (from the offset of the conv outputs). The
+  // base addr and length are latched at the start, and a zero length doesn't
+  // start it. With spad_bulk_dma the whole range is copied in one child
+  // instruction.
+  bool spad_write_back = false;
+
+  // Chain conv layers on-chip: bit 25 of the kernel size config makes the
+  // conv children read the activations from spad1 (at the activation base
+  // addr) instead of the soc memory, and the outputs are written at the
+  // AccelConvOutputsBaseAddr offset of spad1. Swapping the two base addrs
+  // between layers ping-pongs two spad1 regions.
+  bool conv_act_spad1 = false;
+
+  // Run a chain of conv layer descriptors from the soc memory: writing the
+  // addr of the first descriptor into ConfigReg1 (AccelConvDescAddr) starts
+  // the conv descriptor child. Once the previous layer (and its write-back)
+  // is done, it loads the layer weights into spad0 through the SPAD child
+  // and then launches the layer, as ACCEL_CONV_TRIGGER does. The SPAD child
+  // latches its spad offset at the start. See config_reg.h for the
+  // descriptor layout.
+  bool conv_desc_chain = false;
+
+  // Add CFG_REG_WR_WIDE: a write to CFG_REG_WIDE_BASE_ADDR + 16*n sets the
+  // config registers 4n..4n+3 from the 32-bit slices of the 128-bit data
+  // input, thus a layer is configured in a few beats. The trigger registers
+  // (and AccelSpadCFG with spad_write_back) are skipped, the plain 32-bit
+  // writes below CFG_REG_WIDE_BASE_ADDR are kept.
+  bool cfg_wide_write = false;
+
+  // Entries of the conv command queue (0: no queue). An ACCEL_CONV_TRIGGER
+  // while the conv child is busy (or the queue isn't empty) is enqueued with
+  // the current conv config registers instead of restarting the child, and
+  // the conv command queue child launches the head entry once the conv child
+  // (and the write-back of its outputs) is done. A trigger to a full queue
+  // doesn't decode, the host must wait as before.
+  int conv_cmd_queue_depth = 0;
+
+  // Split spad0 and spad1 into two ping-pong halves of SPAD_HALF_BYTE_NUM
+  // bytes. The conv children read the weights at the weight base addr, a
+  // spad0 byte offset. A running conv layer owns the spad0 half of its weights
+  // and the spad1 half of its outputs (with conv_act_spad1 also the spad1
+  // half of its activations, i.e. all of spad1 for a ping-ponged layer), and
+  // the SPAD child only writes into the other halves meanwhile (a beat into
+  // an owned half waits for the conv child to finish), thus the weights of
+  // the next tile are loaded while the current one computes. Only the half
+  // at each base addr is owned: a layer's weights (and its activations and
+  // outputs in spad1) must not cross SPAD_HALF_BYTE_NUM, and a SPAD transfer
+  // must not cross the middle of a spad.
+  bool spad_double_buffer = false;
+
+  // Read request slots of the AXI master child (0: no AXI master, the SPAD
+  // child and the conv act fetch read the soc memory directly). The SPAD
+  // child and the fine-grained conv child issue 16-byte read requests as
+  // long as a slot is free, the conv child up to CONV_BURST_LENGTH act vectors
+  // ahead of its fetch, and consume the responses in order. Each response is
+  // valid after axi_master_latency steps (accel_axi_master_rd_tick) of the
+  // AXI master child.
+  int axi_master_outstanding = 0;
+  int axi_master_latency = 0;
+};
+
+} // namespace hlscnn
+} // namespace ilang
+
+#endif // MODEL_CONFIG_H__
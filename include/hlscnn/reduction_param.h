@@ -71,6 +71,17 @@ namespace hlscnn {
 #define REDUCTION_RELU_THRESHOLD "reduction_relu_threshold"
 #define REDUCTION_RELU_THRESHOLD_BITWIDTH RELU_THRESHOLD_WIDTH
 
+#define REDUCTION_ENABLE_BIAS "reduction_enable_bias"
+#define REDUCTION_ENABLE_BIAS_BITWIDTH REDUCTION_BOOL_WIDTH
+
+// pooling window (rows and cols, also the stride), 0 for the whole input map
+#define REDUCTION_POOL_SIZE "reduction_pool_size"
+#define REDUCTION_POOL_SIZE_BITWIDTH 4
+
+// pooling mode: 0 for max pooling, 1 for average pooling
+#define REDUCTION_POOL_AVG "reduction_pool_avg"
+#define REDUCTION_POOL_AVG_BITWIDTH REDUCTION_BOOL_WIDTH
+
 
 
 } // namespace hlscnn
@@ -72,6 +72,22 @@ namespace hlscnn {
 
   #define TOP_SLAVE_DATA_IN_BITWIDTH 8
 
+  // burst writes into the virtual soc memory (ModelConfig::vir_mem_burst_bytes):
+  // top_slave_burst_len 16-byte beats are taken from top_slave_burst_data_in,
+  // beat 0 in the low bits
+  #define TOP_SLAVE_IF_BURST "top_slave_if_burst"
+  #define TOP_SLAVE_IF_BURST_BITWIDTH 1
+
+  #define TOP_SLAVE_BURST_LEN "top_slave_burst_len"
+  #define TOP_SLAVE_BURST_LEN_BITWIDTH 8
+
+  #define TOP_SLAVE_BURST_DATA_IN "top_slave_burst_data_in"
+
+  // number of 16-byte spad lines of a bulk spad read
+  // (ModelConfig::spad_bulk_readback)
+  #define TOP_SLAVE_RD_LEN "top_slave_rd_len"
+  #define TOP_SLAVE_RD_LEN_BITWIDTH 16
+
   //////////////////////////////////////////////
   // AXI master interface
   //////////////////////////////////////////////
@@ -81,6 +97,9 @@ namespace hlscnn {
 
   // don't model the write req for now.
   // it seems that the HLSCNN only use master for reading data
+  // (except the address of the spad1 write-back child, ModelConfig::spad_write_back)
+  #define TOP_MASTER_WR_ADDR_OUT "top_master_wr_addr_out"
+  #define TOP_MASTER_WR_ADDR_OUT_BITWIDTH 32
 
   // master read only has data
   #define TOP_MASTER_IF_RD "top_master_if_rd"
@@ -130,6 +149,8 @@ namespace hlscnn {
   #define SPAD_DATA_BYTE_WIDTH 16
   #define SPAD_CAPACITY (SPAD_NUM_BANK * 2048)
   #define SPAD_BYTE_ENTRY_NUM (SPAD_CAPACITY * SPAD_DATA_BYTE_WIDTH)
+  // bytes of each ping-pong half of a scratchpad (ModelConfig::spad_double_buffer)
+  #define SPAD_HALF_BYTE_NUM (SPAD_BYTE_ENTRY_NUM / 2)
 
   // base addr for configurations
   #define CONFIG_BASE_ADDR 0X0
@@ -149,6 +170,8 @@ namespace hlscnn {
   // ---------------------------------------------------------------
   #define VIRTUAL_SOC_MEMORY "virtual_soc_memory"
   #define VIRTUAL_SOC_MEMORY_DATA_BITWIDTH 8
+  // word-level memories (ModelConfig::mem_word_level)
+  #define MEM_WORD_DATA_BITWIDTH (NIC_MEM_ELEM_BYTEWIDTH * 8)
   #define VIRTUAL_SOC_MEMORY_BYTE_ENTRY_NUM 0x30000
   #define VIRTUAL_SOC_MEMORY_ADDR_MIN 0x50000
   #define VIRTUAL_SOC_MEMORY_ADDR_MAX                                                  \
@@ -52,6 +52,83 @@ static FuncRef ConvAddBias("ConvAddBias", psum_type, psum_type, act_type);
 static FuncRef Psum2Act("Psum2Act", act_psum_type, psum_type);
 static FuncRef PsumRelu("PsumRelu", psum_type, psum_type);
 
+// datapath functions of the fine-grained conv child for one element bitwidth
+// profile (ModelConfig::conv_weight_bits/conv_act_bits/conv_psum_bits). The
+// default profile uses the functions above, any other profile gets functions
+// of its own sorts named with the profile, e.g. ConvMac_w8_a8_p32
+// (GetConvDpFuncs in conv_child_instr.cc)
+struct ConvDpFuncs {
+  FuncRef mac;          // ConvMac(psum, weight, act)
+  FuncRef mac_psum2act; // ConvMacPsum2Act(psum)
+  FuncRef act_add2psum; // ActAdd2Psum(act, act)
+  FuncRef add_bias;     // ConvAddBias(psum, bias), the bias is CONV_CHAN_BIAS_BITWIDTH
+  FuncRef psum2act;     // Psum2Act(psum)
+  FuncRef psum_relu;    // PsumRelu(psum)
+};
+
+// reduction (pooling) functions: the window is reduced in the psum type and
+// rounded to an activation once, like the conv outputs
+static auto relu_threshold_type = SortRef::BV(RELU_THRESHOLD_WIDTH);
+static auto pool_count_type = SortRef::BV(32);
+
+static FuncRef ReduceMaxPsum("ReduceMaxPsum", psum_type, psum_type, act_type);
+static FuncRef ReduceAddPsum("ReduceAddPsum", psum_type, psum_type, act_type);
+static FuncRef ReduceAvgPsum("ReduceAvgPsum", psum_type, psum_type, pool_count_type);
+static FuncRef PsumReluThreshold("PsumReluThreshold", psum_type, psum_type, relu_threshold_type);
+
+// layer-level conv function: computes the whole conv layer of the fine-grained
+// conv child, returning the updated spad1
+static auto soc_mem_type = SortRef::MEM(TOP_SLAVE_ADDR_IN_BITWIDTH,
+                                        VIRTUAL_SOC_MEMORY_DATA_BITWIDTH);
+static auto spad_type = SortRef::MEM(TOP_SLAVE_ADDR_IN_BITWIDTH,
+                                     SCRATCH_PAD_DATA_BITWIDTH);
+
+static std::vector<SortRef> ConvLayer_in = {
+  soc_mem_type, spad_type, spad_type,
+  SortRef::BV(CFG_REG_BITWIDTH),             // activation base addr
+  SortRef::BV(CONV_INPUT_ROW_NUM_BITWIDTH),  // input rows
+  SortRef::BV(CONV_INPUT_COL_NUM_BITWIDTH),  // input cols
+  SortRef::BV(CONV_INPUT_CHAN_NUM_BITWIDTH), // input channels
+  SortRef::BV(CONV_KERNEL_ROW_NUM_BITWIDTH), // kernel rows
+  SortRef::BV(CONV_KERNEL_COL_NUM_BITWIDTH), // kernel cols
+  SortRef::BV(CONV_KERNEL_R_STRIDE_BITWIDTH),
+  SortRef::BV(CONV_KERNEL_C_STRIDE_BITWIDTH),
+  SortRef::BV(CONV_CHAN_BIAS_BITWIDTH),
+  SortRef::BV(CONV_ENABLE_BIAS_BITWIDTH),
+  SortRef::BV(CONV_ENABLE_RELU_BITWIDTH),
+  SortRef::BV(CONV_ENABLE_ACCUM_BITWIDTH),
+  SortRef::BV(CONV_OFILTER_IDX_BITWIDTH)
+};
+
+static FuncRef ConvLayer("ConvLayer", spad_type, ConvLayer_in);
+
+// bulk byte copy between two byte memories (the scratchpads and the soc
+// memory share the sort): num_bytes bytes of src_mem at src_addr into dst_mem
+// at dst_addr, returning the updated dst_mem. The SPAD child copies soc memory
+// -> spad, the spad1 write-back child spad1 -> soc memory.
+static std::vector<SortRef> SpadBulkCopy_in = {
+  spad_type, soc_mem_type,                 // dst mem, src mem
+  SortRef::BV(TOP_SLAVE_ADDR_IN_BITWIDTH), // dst addr
+  SortRef::BV(CFG_REG_BITWIDTH),           // src addr
+  SortRef::BV(CFG_REG_BITWIDTH)            // num bytes
+};
+
+static FuncRef SpadBulkCopy("SpadBulkCopy", spad_type, SpadBulkCopy_in);
+
+// bulk spad readback: num_elems 16-bit activations from the scratchpad at
+// spad_addr into the output memory at out_addr, returning the output memory
+static auto out_mem_type = SortRef::MEM(TOP_SLAVE_ADDR_IN_BITWIDTH,
+                                        VIRTUAL_OUTPUT_MEMORY_DATA_BITWIDTH);
+
+static std::vector<SortRef> SpadBulkRead_in = {
+  out_mem_type, spad_type,
+  SortRef::BV(TOP_SLAVE_ADDR_IN_BITWIDTH), // output memory addr
+  SortRef::BV(TOP_SLAVE_ADDR_IN_BITWIDTH), // spad addr
+  SortRef::BV(TOP_SLAVE_ADDR_IN_BITWIDTH)  // num elems
+};
+
+static FuncRef SpadBulkRead("SpadBulkRead", out_mem_type, SpadBulkRead_in);
+
 } // namespace ilang
 } // namespace hlscnn
 
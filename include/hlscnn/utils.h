@@ -29,6 +29,7 @@
 
 #include <ilang/ilang++.h>
 #include <hlscnn/hlscnn_top.h>
+#include <vector>
 
 namespace ilang {
 namespace hlscnn {
@@ -42,49 +43,145 @@ inline std::string GetStateName(const std::string& name, const int& idx) {
 }
 
 inline ExprRef GetActVectorState(const Ila& child, const std::string& name,
-                                                        const ExprRef& idx) {
-  auto value = 
-    Ite(idx == 0, child.state(GetStateName(name, 0)),
-    Ite(idx == 1, child.state(GetStateName(name, 1)),
-    Ite(idx == 2, child.state(GetStateName(name, 2)),
-    Ite(idx == 3, child.state(GetStateName(name, 3)),
-    Ite(idx == 4, child.state(GetStateName(name, 4)),
-    Ite(idx == 5, child.state(GetStateName(name, 5)),
-    Ite(idx == 6, child.state(GetStateName(name, 6)),
-                  child.state(GetStateName(name, 7))
-                  )))))));
+                                                        const ExprRef& idx,
+                                                        const int& size = CONV_VECTOR_SIZE) {
+  // the last element is selected for any idx out of range
+  auto value = child.state(GetStateName(name, size - 1));
+  for (auto i = size - 2; i >= 0; i--) {
+    value = Ite(idx == i, child.state(GetStateName(name, i)), value);
+  }
   return value;
 }
 
 ExprRef act_gen_get_addr(const Ila& child, const ExprRef& input_row,
                                                   const ExprRef& input_col,
-                                                  const ExprRef& chan_block);
+                                                  const ExprRef& chan_block,
+                                                  const int& chan_block_size = CHANNEL_BLOCK_SIZE,
+                                                  const int& act_bitwidth = ACT_TOTAL_BITWIDTH);
 
 ExprRef conv_out_of_bound(const Ila& child, const ExprRef& input_row,
                                                    const ExprRef& input_col,
                                                    const ExprRef& k_row,
                                                    const ExprRef& k_col);
 
+// range of the live kernel indices for one input row (or col), bounds are in
+// the bitwidth of the input index
+struct ConvKernelWindow {
+  ExprRef first;
+  ExprRef last;
+  ExprRef is_empty;
+};
+
+ConvKernelWindow conv_kernel_window(const ExprRef& input_idx,
+                                    const ExprRef& kernel_size,
+                                    const ExprRef& input_size,
+                                    const ExprRef& stride);
+
+// address of the current kernel position in CONV_CHILD_WEIGHT_CACHE
+ExprRef ConvWeightCacheAddr(const Ila& child);
+
 ExprRef WtGetAddr(const Ila& child, const ExprRef& filter_id,
                                                const ExprRef& k_row,
                                                const ExprRef& k_col,
-                                               const ExprRef& chan_block);
+                                               const ExprRef& chan_block,
+                                               const int& chan_block_size = CHANNEL_BLOCK_SIZE);
 
 ExprRef OutActGetAddr(const Ila& child, const ExprRef& input_row,
                                         const ExprRef& input_col,
                                         const ExprRef& k_row,
                                         const ExprRef& k_col,
-                                        const ExprRef& filter_idx);
+                                        const ExprRef& filter_idx,
+                                        const int& chan_block_size = CHANNEL_BLOCK_SIZE,
+                                        const int& act_bitwidth = ACT_TOTAL_BITWIDTH);
 
 ExprRef WtIsLastPsum(const Ila& child, const ExprRef& act_row,
                                        const ExprRef& act_col,
                                        const ExprRef& k_row,
                                        const ExprRef& k_col,
-                                       const ExprRef& chan_block);
-
-ExprRef GetCfgRegAlignedData();
-
-void SetConfigRegWrInstr(Ila& m, const int& reg_idx, const std::string& reg_name);
+                                       const ExprRef& chan_block,
+                                       const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+
+// number of input channel blocks of the current conv layer
+ExprRef ConvLastChanBlock(const Ila& child, const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+// Grouped conv (ModelConfig::conv_grouped) with 2^CONV_GROUP_NUM_LOG2 groups:
+// input channels per group
+ExprRef ConvGroupChans(const Ila& child);
+// whether the layer is grouped: CONV_GROUP_NUM_LOG2 is set, the channels and
+// the filters split evenly over the groups, and the channels of a group are
+// whole channel blocks or a divisor of the channel block size
+ExprRef ConvIsGrouped(const Ila& child, const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+// input channel blocks reduced by each filter
+ExprRef ConvFilterChanBlocks(const Ila& child, const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+// first input channel block of the filter's group
+ExprRef ConvFilterFirstChanBlock(const Ila& child, const ExprRef& filter_idx,
+                                 const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+// lanes of a channel block holding the filter's channels, and the first one:
+// all the lanes unless a group has fewer channels than a channel block
+ExprRef ConvFilterLanes(const Ila& child, const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+ExprRef ConvFilterFirstLane(const Ila& child, const ExprRef& filter_idx,
+                            const int& chan_block_size = CHANNEL_BLOCK_SIZE);
+// spad0 byte address of the weights of the filter's lanes at a kernel position
+// and channel block, with only the group's channels stored per filter, from
+// the weight base with ping-pong halves (see ConvWtSpad0Base)
+ExprRef ConvGroupedWtAddr(const Ila& child, const ExprRef& filter_id,
+                                            const ExprRef& k_row,
+                                            const ExprRef& k_col,
+                                            const ExprRef& chan_block,
+                                            const int& chan_block_size = CHANNEL_BLOCK_SIZE,
+                                            const bool& ping_pong = false);
+// number of filter groups of the conv layer, group_size filters each
+ExprRef ConvLastFilterGroup(const Ila& child, const int& group_size = CONV_VECTOR_SIZE);
+
+// whether the current kernel fits in the coarse-grained conv child
+ExprRef ConvCoarseKernelFit(const Ila& child);
+
+// spad1 offset of the conv outputs: CONV_SPAD_OUTPUT_BASE with ping-pong
+// regions (ModelConfig::conv_act_spad1), 0 otherwise
+ExprRef ConvOutSpad1Base(const Ila& child, const bool& ping_pong);
+// spad0 offset of the conv weights: CONV_WEIGHT_BASE with ping-pong halves
+// (ModelConfig::spad_double_buffer), 0 otherwise
+ExprRef ConvWtSpad0Base(const Ila& child, const bool& ping_pong);
+// whether spad_addr of spad0/spad1 (spad_idx) is in a half owned by a
+// running conv layer (ModelConfig::spad_double_buffer), including the spad1
+// half of its activations with act_spad1 (ModelConfig::conv_act_spad1)
+ExprRef SpadIsConvOwned(const Ila& m, const int& spad_idx, const ExprRef& spad_addr,
+                        const bool& act_spad1 = false);
+// num act_bitwidth-bit activations at addr of the virtual soc memory, or of
+// spad1 when CONV_ACT_SRC_SPAD1 is set (ModelConfig::conv_act_spad1)
+std::vector<ExprRef> ConvLoadActVector(const Ila& child, const ExprRef& addr, const int& num,
+                                       const bool& spad1_src,
+                                       const int& act_bitwidth = ACT_TOTAL_BITWIDTH);
+
+// Accessors of the scratchpads and the virtual soc memory, which hold bytes,
+// or NIC_MEM_ELEM_BYTEWIDTH-byte words (byte 0 in the low bits) with
+// ModelConfig::mem_word_level. The addresses are byte addresses either way.
+inline bool MemIsWordLevel(const ExprRef& mem) {
+  return (mem.data_width() == NIC_MEM_ELEM_BYTEWIDTH * 8);
+}
+// num bytes from addr, which must not cross a word of a word-level memory unless
+// it is word-aligned
+std::vector<ExprRef> MemLoadBytes(const ExprRef& mem, const ExprRef& addr, const int& num);
+// num act_bitwidth-bit elements (byte 0 of an element in its low bits) from a
+// word-aligned addr
+std::vector<ExprRef> MemLoadActVector(const ExprRef& mem, const ExprRef& addr,
+                                      const int& num = CONV_VECTOR_SIZE,
+                                      const int& act_bitwidth = ACT_TOTAL_BITWIDTH);
+// the element width is the bitwidth of acts
+ExprRef MemStoreActVector(const ExprRef& mem, const ExprRef& addr,
+                          const std::vector<ExprRef>& acts);
+// NIC_MEM_ELEM_BYTEWIDTH bytes (byte 0 in the low bits) at a word-aligned addr
+ExprRef MemLoadWord(const ExprRef& mem, const ExprRef& addr);
+ExprRef MemStoreWord(const ExprRef& mem, const ExprRef& addr, const ExprRef& data);
+
+ExprRef GetCfgRegAlignedData(const Ila& m);
+// the 16 data bytes of the slave beat, byte 0 in the low bits
+ExprRef GetSlaveDataBeat(const Ila& m);
+// whether masked_addr is a 32-bit config register write, the 128-bit writes of
+// ModelConfig::cfg_wide_write have their own window
+ExprRef CfgRegIsConfigAddr(const ExprRef& masked_addr, const bool& wide_write);
+
+void SetConfigRegWrInstr(Ila& m, const int& reg_idx, const std::string& reg_name,
+                         const bool& wide_write = false);
 
 
 }
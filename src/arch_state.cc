@@ -30,19 +30,26 @@
 namespace ilang {
 namespace hlscnn {
 
-void DefineArchState(Ila& m) {
+void DefineArchState(Ila& m, const ModelConfig& cfg) {
+  // word-level memories hold NIC_MEM_ELEM_BYTEWIDTH bytes per entry
+  auto spad_data_bitwidth = (cfg.mem_word_level) ?
+    MEM_WORD_DATA_BITWIDTH : SCRATCH_PAD_DATA_BITWIDTH;
+  auto vir_mem_data_bitwidth = (cfg.mem_word_level) ?
+    MEM_WORD_DATA_BITWIDTH : VIRTUAL_SOC_MEMORY_DATA_BITWIDTH;
+  auto entry_bytes = (cfg.mem_word_level) ? NIC_MEM_ELEM_BYTEWIDTH : 1;
+
   // scratchpad0 and scratchpad1 are declared as memstate here
-  m.NewMemState(SCRATCH_PAD_0, TOP_SLAVE_ADDR_IN_BITWIDTH, SCRATCH_PAD_DATA_BITWIDTH);
-  m.state(SCRATCH_PAD_0).SetEntryNum(SPAD_BYTE_ENTRY_NUM);
+  m.NewMemState(SCRATCH_PAD_0, TOP_SLAVE_ADDR_IN_BITWIDTH, spad_data_bitwidth);
+  m.state(SCRATCH_PAD_0).SetEntryNum(SPAD_BYTE_ENTRY_NUM / entry_bytes);
 
-  m.NewMemState(SCRATCH_PAD_1, TOP_SLAVE_ADDR_IN_BITWIDTH, SCRATCH_PAD_DATA_BITWIDTH);
-  m.state(SCRATCH_PAD_1).SetEntryNum(SPAD_BYTE_ENTRY_NUM);
+  m.NewMemState(SCRATCH_PAD_1, TOP_SLAVE_ADDR_IN_BITWIDTH, spad_data_bitwidth);
+  m.state(SCRATCH_PAD_1).SetEntryNum(SPAD_BYTE_ENTRY_NUM / entry_bytes);
 
   // ---------------------------------------------------------------------------------
   // Declare a virtual memeory state for external memory
   // ---------------------------------------------------------------------------------
-  m.NewMemState(VIRTUAL_SOC_MEMORY, TOP_SLAVE_ADDR_IN_BITWIDTH, VIRTUAL_SOC_MEMORY_DATA_BITWIDTH);
-  m.state(VIRTUAL_SOC_MEMORY).SetEntryNum(VIRTUAL_SOC_MEMORY_BYTE_ENTRY_NUM);
+  m.NewMemState(VIRTUAL_SOC_MEMORY, TOP_SLAVE_ADDR_IN_BITWIDTH, vir_mem_data_bitwidth);
+  m.state(VIRTUAL_SOC_MEMORY).SetEntryNum(VIRTUAL_SOC_MEMORY_BYTE_ENTRY_NUM / entry_bytes);
 
   // virtual memory for outputs
   m.NewMemState(VIRTUAL_OUTPUT_MEMORY, TOP_SLAVE_ADDR_IN_BITWIDTH, VIRTUAL_OUTPUT_MEMORY_DATA_BITWIDTH);
@@ -22,133 +22,103 @@
 // SOFTWARE.
 // =============================================================================
 
+
 // File: axi_master_child_instr.cc
 
+// This file contains the AXI master child, which models the read requests of
+// the SPAD child and of the conv activation fetch to the soc memory: up to
+// ModelConfig::axi_master_outstanding requests are in flight, each response
+// is valid ModelConfig::axi_master_latency child steps after its request, and
+// the responses are returned in the order of the requests.
+
 #include <ilang/ilang++.h>
 #include <hlscnn/hlscnn_top.h>
 
 namespace ilang {
 namespace hlscnn {
 
-void DefineAXIMasterChild(Ila& m) {
-
-  auto child = m.NewChild("ACCEL_AXI_MASTER_CHILD");
-  auto is_child_valid = 
-    (m.state(ACCEL_MASTER_AXI_CHILD_VALID_FLAG) == ACCEL_MASTER_AXI_CHILD_VALID);
-  
-  child.SetValid(is_child_valid);
-
-  auto state = m.state(ACCEL_MASTER_AXI_CHILD_STATE);
-  auto rd_resp_valid_flag = m.input(TOP_MASTER_RD_RESP_VALID_FLAG);
+ExprRef AXIMasterRdPtrNext(const ExprRef& ptr, const ModelConfig& cfg) {
+  return Ite(ptr >= cfg.axi_master_outstanding - 1,
+             BvConst(0, AXI_MASTER_RD_PTR_BITWIDTH), ptr + 1);
+}
 
-  child.AddInit(rd_resp_valid_flag == ACCEL_MASTER_AXI_CHILD_INVALID);
-  child.AddInit(state == MASTER_AXI_CHILD_STATE_IDLE);
+ExprRef AXIMasterRdReqReady(const Ila& m, const ModelConfig& cfg) {
+  return (m.state(AXI_MASTER_RD_CNT) < cfg.axi_master_outstanding);
+}
 
-  // This file contains only the AXI instructions for spad write
-  // This activation fetching instructions are integrated into the conv child
+void SetAXIMasterRdReq(InstrRef& instr, Ila& m, const ModelConfig& cfg,
+                       const ExprRef& addr, const int& src) {
+  auto tail = m.state(AXI_MASTER_RD_TAIL);
+  auto cnt = m.state(AXI_MASTER_RD_CNT);
+
+  // the beat is taken when the request is issued, the latency only delays
+  // its response
+  auto data = MemLoadWord(m.state(VIRTUAL_SOC_MEMORY), addr);
+  for (auto i = 0; i < cfg.axi_master_outstanding; i++) {
+    auto slot_data = m.state(GetStateName(AXI_MASTER_RD_DATA, i));
+    auto slot_lat = m.state(GetStateName(AXI_MASTER_RD_LAT, i));
+    auto slot_src = m.state(GetStateName(AXI_MASTER_RD_SRC, i));
+    auto is_tail = (tail == i);
+    instr.SetUpdate(slot_data, Ite(is_tail, data, slot_data));
+    instr.SetUpdate(slot_lat,
+      Ite(is_tail, BvConst(cfg.axi_master_latency, AXI_MASTER_RD_LAT_BITWIDTH), slot_lat));
+    instr.SetUpdate(slot_src,
+      Ite(is_tail, BvConst(src, AXI_MASTER_RD_SRC_BITWIDTH), slot_src));
+  }
 
-  { // instr 0 ---- AXI master read req for weights or activations to MEM ()
-    auto instr = child.NewInstr("accel_axi_master_rd_req_spad");
-    auto is_instr_valid = ((rd_resp_valid_flag == ACCEL_MASTER_AXI_CHILD_INVALID) &
-                            ((state == MASTER_AXI_CHILD_STATE_SPAD0_RD) |  
-                              (state == MASTER_AXI_CHILD_STATE_SPAD1_RD)));
+  instr.SetUpdate(tail, AXIMasterRdPtrNext(tail, cfg));
+  instr.SetUpdate(cnt, cnt + 1);
 
-    instr.SetDecode(is_instr_valid);
+  instr.SetUpdate(m.state(TOP_MASTER_IF_RD), BvConst(1, TOP_MASTER_IF_RD_BITWIDTH));
+  instr.SetUpdate(m.state(TOP_MASTER_RD_ADDR_OUT), addr);
+}
 
-    auto addr = m.state(CFG_REG_SOC_MEM_BASE_ADDR);
-    // the number of beat / burst length is set to be 1
-    auto num_beat = m.state(CFG_REG_SOC_MEM_RD_WR_LENGTH); 
+ExprRef AXIMasterRdRespValid(const Ila& m, const ModelConfig& cfg, const int& src) {
+  auto head = m.state(AXI_MASTER_RD_HEAD);
+  auto size = cfg.axi_master_outstanding;
+  auto head_lat = GetActVectorState(m, AXI_MASTER_RD_LAT, head, size);
+  auto head_src = GetActVectorState(m, AXI_MASTER_RD_SRC, head, size);
+  return (m.state(AXI_MASTER_RD_CNT) != 0) & (head_lat == 0) & (head_src == src);
+}
 
-    instr.SetUpdate(m.state(TOP_MASTER_IF_RD), 
-                    BvConst(ACCEL_MASTER_AXI_CHILD_VALID, TOP_MASTER_IF_RD_BITWIDTH));
-    instr.SetUpdate(m.state(TOP_MASTER_RD_ADDR_OUT), addr);
-  }
+ExprRef AXIMasterRdRespData(const Ila& m, const ModelConfig& cfg) {
+  return GetActVectorState(m, AXI_MASTER_RD_DATA, m.state(AXI_MASTER_RD_HEAD),
+                           cfg.axi_master_outstanding);
+}
 
-  { // instr 1 ---- AXI master receive the data from mem and write it into SPAD0
-    auto instr = child.NewInstr("accel_axi_master_rd_recv_spad0");
-    auto is_instr_valid = ((rd_resp_valid_flag == ACCEL_MASTER_AXI_CHILD_VALID) &
-                            (state == MASTER_AXI_CHILD_STATE_SPAD0_RD));
-
-    instr.SetDecode(is_instr_valid);
-
-    auto spad_addr = m.state(ACCEL_SPAD_WR_ADDR);
-    // auto spad = Ite(state == MASTER_AXI_CHILD_STATE_SPAD0_RD,
-    //                 m.state(SCRATCH_PAD_0), m.state(SCRATCH_PAD_1));
-    auto spad = m.state(SCRATCH_PAD_0);
-    auto spad_next = spad;
-
-    spad_next = Store(spad_next, spad_addr+0, m.input(TOP_MASTER_DATA_IN_0));
-    spad_next = Store(spad_next, spad_addr+1, m.input(TOP_MASTER_DATA_IN_1));
-    spad_next = Store(spad_next, spad_addr+2, m.input(TOP_MASTER_DATA_IN_2));
-    spad_next = Store(spad_next, spad_addr+3, m.input(TOP_MASTER_DATA_IN_3));
-    spad_next = Store(spad_next, spad_addr+4, m.input(TOP_MASTER_DATA_IN_4));
-    spad_next = Store(spad_next, spad_addr+5, m.input(TOP_MASTER_DATA_IN_5));
-    spad_next = Store(spad_next, spad_addr+6, m.input(TOP_MASTER_DATA_IN_6));
-    spad_next = Store(spad_next, spad_addr+7, m.input(TOP_MASTER_DATA_IN_7));
-    spad_next = Store(spad_next, spad_addr+8, m.input(TOP_MASTER_DATA_IN_8));
-    spad_next = Store(spad_next, spad_addr+9, m.input(TOP_MASTER_DATA_IN_9));
-    spad_next = Store(spad_next, spad_addr+10, m.input(TOP_MASTER_DATA_IN_10));
-    spad_next = Store(spad_next, spad_addr+11, m.input(TOP_MASTER_DATA_IN_11));
-    spad_next = Store(spad_next, spad_addr+12, m.input(TOP_MASTER_DATA_IN_12));
-    spad_next = Store(spad_next, spad_addr+13, m.input(TOP_MASTER_DATA_IN_13));
-    spad_next = Store(spad_next, spad_addr+14, m.input(TOP_MASTER_DATA_IN_14));
-    spad_next = Store(spad_next, spad_addr+15, m.input(TOP_MASTER_DATA_IN_15));
-
-    instr.SetUpdate(spad, spad_next);
-    
-    instr.SetUpdate(m.state(TOP_MASTER_IF_RD), 
-                    BvConst(ACCEL_MASTER_AXI_CHILD_INVALID, TOP_MASTER_IF_RD_BITWIDTH));
-    
-    instr.SetUpdate(state,
-                    BvConst(MASTER_AXI_CHILD_STATE_IDLE, ACCEL_MASTER_AXI_CHILD_STATE_BITWIDTH));
-
-    instr.SetUpdate(m.state(ACCEL_MASTER_AXI_CHILD_VALID_FLAG),
-                    BvConst(ACCEL_MASTER_AXI_CHILD_INVALID, TOP_MASTER_IF_RD_BITWIDTH));
-  }
+void SetAXIMasterRdResp(InstrRef& instr, Ila& m, const ModelConfig& cfg) {
+  auto head = m.state(AXI_MASTER_RD_HEAD);
+  auto cnt = m.state(AXI_MASTER_RD_CNT);
+  instr.SetUpdate(head, AXIMasterRdPtrNext(head, cfg));
+  instr.SetUpdate(cnt, cnt - 1);
+  instr.SetUpdate(m.state(TOP_MASTER_IF_RD),
+    Ite(cnt == 1, BvConst(0, TOP_MASTER_IF_RD_BITWIDTH), BvConst(1, TOP_MASTER_IF_RD_BITWIDTH)));
+}
 
-  { // instr 2 ---- AXI master receive the data from mem and write it into SPAD1
-    auto instr = child.NewInstr("accel_axi_master_rd_recv_spad1");
-    auto is_instr_valid = ((rd_resp_valid_flag == ACCEL_MASTER_AXI_CHILD_VALID) &
-                            (state == MASTER_AXI_CHILD_STATE_SPAD1_RD));
-
-    instr.SetDecode(is_instr_valid);
-
-    auto spad_addr = m.state(ACCEL_SPAD_WR_ADDR);
-    // auto spad = Ite(state == MASTER_AXI_CHILD_STATE_SPAD0_RD,
-    //                 m.state(SCRATCH_PAD_0), m.state(SCRATCH_PAD_1));
-    auto spad = m.state(SCRATCH_PAD_1);
-    auto spad_next = spad;
-
-    spad_next = Store(spad_next, spad_addr+0, m.input(TOP_MASTER_DATA_IN_0));
-    spad_next = Store(spad_next, spad_addr+1, m.input(TOP_MASTER_DATA_IN_1));
-    spad_next = Store(spad_next, spad_addr+2, m.input(TOP_MASTER_DATA_IN_2));
-    spad_next = Store(spad_next, spad_addr+3, m.input(TOP_MASTER_DATA_IN_3));
-    spad_next = Store(spad_next, spad_addr+4, m.input(TOP_MASTER_DATA_IN_4));
-    spad_next = Store(spad_next, spad_addr+5, m.input(TOP_MASTER_DATA_IN_5));
-    spad_next = Store(spad_next, spad_addr+6, m.input(TOP_MASTER_DATA_IN_6));
-    spad_next = Store(spad_next, spad_addr+7, m.input(TOP_MASTER_DATA_IN_7));
-    spad_next = Store(spad_next, spad_addr+8, m.input(TOP_MASTER_DATA_IN_8));
-    spad_next = Store(spad_next, spad_addr+9, m.input(TOP_MASTER_DATA_IN_9));
-    spad_next = Store(spad_next, spad_addr+10, m.input(TOP_MASTER_DATA_IN_10));
-    spad_next = Store(spad_next, spad_addr+11, m.input(TOP_MASTER_DATA_IN_11));
-    spad_next = Store(spad_next, spad_addr+12, m.input(TOP_MASTER_DATA_IN_12));
-    spad_next = Store(spad_next, spad_addr+13, m.input(TOP_MASTER_DATA_IN_13));
-    spad_next = Store(spad_next, spad_addr+14, m.input(TOP_MASTER_DATA_IN_14));
-    spad_next = Store(spad_next, spad_addr+15, m.input(TOP_MASTER_DATA_IN_15));
-
-    instr.SetUpdate(spad, spad_next);
-    
-    instr.SetUpdate(m.state(TOP_MASTER_IF_RD), 
-                    BvConst(ACCEL_MASTER_AXI_CHILD_INVALID, TOP_MASTER_IF_RD_BITWIDTH));
-    
-    instr.SetUpdate(state,
-                    BvConst(MASTER_AXI_CHILD_STATE_IDLE, ACCEL_MASTER_AXI_CHILD_STATE_BITWIDTH));
-
-    instr.SetUpdate(m.state(ACCEL_MASTER_AXI_CHILD_VALID_FLAG),
-                    BvConst(ACCEL_MASTER_AXI_CHILD_INVALID, TOP_MASTER_IF_RD_BITWIDTH));
+void DefineAXIMasterChild(Ila& m, const ModelConfig& cfg) {
+  auto child = m.NewChild("ACCEL_AXI_MASTER_CHILD");
+  auto cnt = m.state(AXI_MASTER_RD_CNT);
+  child.SetValid(cnt != 0);
+
+  // the requests and the responses are issued/consumed by the instructions
+  // of the SPAD child and the conv child, this child only advances the time
+
+  { // instr ---- one memory cycle of the in-flight requests
+    auto instr = child.NewInstr("accel_axi_master_rd_tick");
+
+    auto is_in_flight = BoolConst(false);
+    for (auto i = 0; i < cfg.axi_master_outstanding; i++) {
+      is_in_flight = is_in_flight | (m.state(GetStateName(AXI_MASTER_RD_LAT, i)) != 0);
+    }
+    instr.SetDecode((cnt != 0) & is_in_flight);
+
+    // the latency of a free slot is 0 once its response is consumed
+    for (auto i = 0; i < cfg.axi_master_outstanding; i++) {
+      auto slot_lat = m.state(GetStateName(AXI_MASTER_RD_LAT, i));
+      instr.SetUpdate(slot_lat, Ite(slot_lat != 0, slot_lat - 1, slot_lat));
+    }
   }
-  
 }
 
 } // namespace hlscnn
-} // namespace ilang
\ No newline at end of file
+} // namespace ilang
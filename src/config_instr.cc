@@ -26,11 +26,14 @@
 
 #include <ilang/ilang++.h>
 #include <hlscnn/hlscnn_top.h>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ilang {
 namespace hlscnn {
 
-void DefineConfigInstr(Ila& m) {
+void DefineConfigInstr(Ila& m, const ModelConfig& cfg) {
   
   // define config write instructions
   auto is_write = (m.input(TOP_SLAVE_IF_WR) & ~m.input(TOP_SLAVE_IF_RD));
@@ -39,7 +42,8 @@ void DefineConfigInstr(Ila& m) {
   // offset from the CPU.""
   auto masked_addr = Concat(BvConst(0, 8), 
                             Extract(m.input(TOP_SLAVE_ADDR_IN), 23, 0));
-  auto is_config_addr = (masked_addr < SPAD0_BASE_ADDR);
+  auto wide_write = cfg.cfg_wide_write;
+  auto is_config_addr = CfgRegIsConfigAddr(masked_addr, wide_write);
 
   // get the aligned data. Reg data is only 32 bit
 
@@ -76,7 +80,13 @@ void DefineConfigInstr(Ila& m) {
     instr.SetUpdate(m.state(FC_ACT_FUNC), Extract(bias_activation, ACT_FUNC_WIDTH - 1, 0));
     instr.SetUpdate(m.state(FC_RELU_THRESHOLD), Extract(bias_activation, 24, 3));
     
-    // TODO: Push FC trigger here
+    if (cfg.fc_child) {
+      // start the FC child
+      instr.SetUpdate(m.state(ACCEL_FC_CHILD_VALID_FLAG),
+                      BvConst(ACCEL_FC_CHILD_VALID, ACCEL_FC_CHILD_VALID_FLAG_BITWIDTH));
+      instr.SetUpdate(m.state(ACCEL_FC_CHILD_STATE),
+                      BvConst(FC_CHILD_STATE_IDLE, ACCEL_FC_CHILD_STATE_BITWIDTH));
+    }
 
   }
 
@@ -143,35 +153,112 @@ void DefineConfigInstr(Ila& m) {
     instr.SetUpdate(m.state(REDUCTION_RELU_THRESHOLD), Extract(general_bias_config, 24, 3));
     instr.SetUpdate(m.state(REDUCTION_ACT_FUNC), Extract(general_bias_config, 1, 0));
     
-    // TODO: Push Reduction trigger here
+    if (cfg.reduction_child) {
+      instr.SetUpdate(m.state(REDUCTION_POOL_SIZE), Extract(reduction_bias_config, 19, 16));
+      instr.SetUpdate(m.state(REDUCTION_POOL_AVG), SelectBit(reduction_bias_config, 20));
+      instr.SetUpdate(m.state(REDUCTION_ENABLE_BIAS), SelectBit(general_bias_config, 2));
+
+      // start the reduction child
+      instr.SetUpdate(m.state(ACCEL_REDUCTION_CHILD_VALID_FLAG),
+                      BvConst(ACCEL_REDUCTION_CHILD_VALID, ACCEL_REDUCTION_CHILD_VALID_FLAG_BITWIDTH));
+      instr.SetUpdate(m.state(ACCEL_REDUCTION_CHILD_STATE),
+                      BvConst(REDUCTION_CHILD_STATE_IDLE, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH));
+    }
 
   }
 
   // other config register wr instrucitons
-  SetConfigRegWrInstr(m, SocMemBaseAddr, CFG_REG_SOC_MEM_BASE_ADDR);
-  SetConfigRegWrInstr(m, SocMemRdWrLength, CFG_REG_SOC_MEM_RD_WR_LENGTH);
+  SetConfigRegWrInstr(m, SocMemBaseAddr, CFG_REG_SOC_MEM_BASE_ADDR, wide_write);
+  SetConfigRegWrInstr(m, SocMemRdWrLength, CFG_REG_SOC_MEM_RD_WR_LENGTH, wide_write);
 
   // SetConfigRegWrInstr(m, AccelSpadCFG, CFG_REG_ACCEL_SPAD_CFG);
 
+  if (cfg.spad_write_back) {
+    // write AccelSpadCFG: the spad1 offset of the write-back region, which
+    // also starts the write-back child
+    auto instr = m.NewInstr("CFG_REG_WR_ACCEL_SPAD_CFG");
+    instr.SetDecode(is_write & is_config_addr & (reg_id == AccelSpadCFG));
+
+    auto spad_cfg = m.state(CFG_REG_ACCEL_SPAD_CFG);
+    auto data = GetCfgRegAlignedData(m);
+    instr.SetUpdate(spad_cfg, data);
+    SetSPADWriteBackStart(instr, m, BoolConst(true), data);
+  }
+
   // // SetConfigRegWrInstr(m, AccelStartFlagReg, CFG_REG_ACCEL_FC_START_FLAG_REG);
-  // SetConfigRegWrInstr(m, AccelFCWeightsBase, CFG_REG_ACCEL_FC_WEIGHT_BASE);
-  // SetConfigRegWrInstr(m, AccelFCActivationBase, CFG_REG_ACCEL_FC_ACT_BASE);
-  // SetConfigRegWrInstr(m, AccelFCSizeConfig, CFG_REG_ACCEL_FC_SIZE_CONFIG);
-  // SetConfigRegWrInstr(m, AccelBiasActivationConfig, CFG_REG_ACCEL_BIAS_ACT_CONFIG);
+  if (cfg.fc_child) {
+    SetConfigRegWrInstr(m, AccelFCWeightsBase, CFG_REG_ACCEL_FC_WEIGHT_BASE);
+    SetConfigRegWrInstr(m, AccelFCActivationBase, CFG_REG_ACCEL_FC_ACT_BASE);
+    SetConfigRegWrInstr(m, AccelFCSizeConfig, CFG_REG_ACCEL_FC_SIZE_CONFIG);
+  }
+  // shared by the FC and the reduction child
+  if (cfg.fc_child || cfg.reduction_child) {
+    SetConfigRegWrInstr(m, AccelBiasActivationConfig, CFG_REG_ACCEL_BIAS_ACT_CONFIG);
+  }
   
-  SetConfigRegWrInstr(m, AccelConvActivationBaseAddr, CFG_REG_ACCEL_CONV_ACT_BASE_ADDR);
-  SetConfigRegWrInstr(m, AccelConvWeightsBaseAddr, CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR);
-  SetConfigRegWrInstr(m, AccelConvOutputsBaseAddr, CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR);
-  SetConfigRegWrInstr(m, AccelConvInputSizeConfig, CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG);
-  SetConfigRegWrInstr(m, AccelConvOutputSizeConfig, CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG);
-  SetConfigRegWrInstr(m, AccelConvKernelSizeConfig, CFG_REG_ACCEL_KERNEL_SIZE_CFG);
-  SetConfigRegWrInstr(m, AccelConvChannelConfig, CFG_REG_ACCEL_CONV_CHANNEL_CFG);
-
-  // SetConfigRegWrInstr(m, AccelReductionInputBaseAddr, CFG_REG_ACCEL_REDUCTION_INPUT_BASE_ADDR);
-  // SetConfigRegWrInstr(m, AccelReductionOutputBaseAddr, CFG_REG_ACCEL_REDUCTION_OUTPUT_BASE_ADDR);
-  // SetConfigRegWrInstr(m, AccelReductionInputSizeConfig, CFG_REG_ACCEL_REDUCTION_INPUT_SIZE_CFG);
-  // SetConfigRegWrInstr(m, AccelReductionBiasConfig, CFG_REG_ACCEL_REDUCTION_BIAS_CONFIG);
+  SetConfigRegWrInstr(m, AccelConvActivationBaseAddr, CFG_REG_ACCEL_CONV_ACT_BASE_ADDR, wide_write);
+  SetConfigRegWrInstr(m, AccelConvWeightsBaseAddr, CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR, wide_write);
+  SetConfigRegWrInstr(m, AccelConvOutputsBaseAddr, CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR, wide_write);
+  SetConfigRegWrInstr(m, AccelConvInputSizeConfig, CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG, wide_write);
+  SetConfigRegWrInstr(m, AccelConvOutputSizeConfig, CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG, wide_write);
+  SetConfigRegWrInstr(m, AccelConvKernelSizeConfig, CFG_REG_ACCEL_KERNEL_SIZE_CFG, wide_write);
+  SetConfigRegWrInstr(m, AccelConvChannelConfig, CFG_REG_ACCEL_CONV_CHANNEL_CFG, wide_write);
+
+  if (cfg.reduction_child) {
+    SetConfigRegWrInstr(m, AccelReductionInputBaseAddr, CFG_REG_ACCEL_REDUCTION_INPUT_BASE_ADDR);
+    SetConfigRegWrInstr(m, AccelReductionOutputBaseAddr, CFG_REG_ACCEL_REDUCTION_OUTPUT_BASE_ADDR);
+    SetConfigRegWrInstr(m, AccelReductionInputSizeConfig, CFG_REG_ACCEL_REDUCTION_INPUT_SIZE_CFG);
+    SetConfigRegWrInstr(m, AccelReductionBiasConfig, CFG_REG_ACCEL_REDUCTION_BIAS_CONFIG);
+  }
 
+  if (wide_write) { // write the 4 config registers of a line from one 128-bit beat
+    auto instr = m.NewInstr("CFG_REG_WR_WIDE");
+    auto is_wide_addr = (masked_addr >= CFG_REG_WIDE_BASE_ADDR) &
+      (masked_addr < CFG_REG_WIDE_BASE_ADDR + NumCfgRegisters * CFG_REG_BYTEWIDTH);
+
+    instr.SetDecode(is_write & is_wide_addr);
+
+    auto line = (masked_addr - CFG_REG_WIDE_BASE_ADDR) >> 4;
+    auto beat = GetSlaveDataBeat(m);
+
+    // all the config registers without a trigger instruction
+    std::vector<std::pair<int, std::string>> wide_regs = {
+      {SocMemBaseAddr, CFG_REG_SOC_MEM_BASE_ADDR},
+      {SocMemRdWrLength, CFG_REG_SOC_MEM_RD_WR_LENGTH},
+      {AccelConvActivationBaseAddr, CFG_REG_ACCEL_CONV_ACT_BASE_ADDR},
+      {AccelConvWeightsBaseAddr, CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR},
+      {AccelConvOutputsBaseAddr, CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR},
+      {AccelConvInputSizeConfig, CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG},
+      {AccelConvOutputSizeConfig, CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG},
+      {AccelConvKernelSizeConfig, CFG_REG_ACCEL_KERNEL_SIZE_CFG},
+      {AccelConvChannelConfig, CFG_REG_ACCEL_CONV_CHANNEL_CFG}
+    };
+    // the same registers as the 32-bit write instructions above
+    if (cfg.fc_child) {
+      wide_regs.push_back({AccelFCWeightsBase, CFG_REG_ACCEL_FC_WEIGHT_BASE});
+      wide_regs.push_back({AccelFCActivationBase, CFG_REG_ACCEL_FC_ACT_BASE});
+      wide_regs.push_back({AccelFCSizeConfig, CFG_REG_ACCEL_FC_SIZE_CONFIG});
+    }
+    if (cfg.fc_child || cfg.reduction_child) {
+      wide_regs.push_back({AccelBiasActivationConfig, CFG_REG_ACCEL_BIAS_ACT_CONFIG});
+    }
+    if (cfg.reduction_child) {
+      wide_regs.push_back({AccelReductionInputBaseAddr, CFG_REG_ACCEL_REDUCTION_INPUT_BASE_ADDR});
+      wide_regs.push_back({AccelReductionOutputBaseAddr, CFG_REG_ACCEL_REDUCTION_OUTPUT_BASE_ADDR});
+      wide_regs.push_back({AccelReductionInputSizeConfig, CFG_REG_ACCEL_REDUCTION_INPUT_SIZE_CFG});
+      wide_regs.push_back({AccelReductionBiasConfig, CFG_REG_ACCEL_REDUCTION_BIAS_CONFIG});
+    }
+    if (!cfg.spad_write_back) {
+      wide_regs.push_back({AccelSpadCFG, CFG_REG_ACCEL_SPAD_CFG});
+    }
+
+    for (auto& reg : wide_regs) {
+      auto reg_state = m.state(reg.second);
+      auto slice = reg.first % 4;
+      auto reg_data = Extract(beat, CFG_REG_BITWIDTH * (slice + 1) - 1, CFG_REG_BITWIDTH * slice);
+      instr.SetUpdate(reg_state, Ite(line == reg.first / 4, reg_data, reg_state));
+    }
+  }
 }
 
 } // namespace hlscnn
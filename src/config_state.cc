@@ -79,7 +79,7 @@ void DefineFCParam(Ila& m) {
   m.NewBvState(FC_RELU_THRESHOLD, FC_RELU_THRESHOLD_BITWIDTH);
 }
 
-void DefineConvParam(Ila& m) {
+void DefineConvParam(Ila& m, const ModelConfig& cfg) {
 
   m.NewBvState(CONV_ACT_BASE, CONV_ACT_BASE_BITWIDTH);
   m.NewBvState(CONV_WEIGHT_BASE, CONV_WEIGHT_BASE_BITWIDTH);
@@ -109,9 +109,21 @@ void DefineConvParam(Ila& m) {
 
   m.NewBvState(CONV_CHAN_BIAS, CONV_CHAN_BIAS_BITWIDTH);
 
+  if (cfg.conv_grouped) {
+    m.NewBvState(CONV_GROUP_NUM_LOG2, CONV_GROUP_NUM_LOG2_BITWIDTH);
+  }
+
+  if (cfg.conv_fused_pool) {
+    m.NewBvState(CONV_POOL_SIZE, CONV_POOL_SIZE_BITWIDTH);
+    m.NewBvState(CONV_POOL_AVG, CONV_POOL_AVG_BITWIDTH);
+  }
+  if (cfg.conv_act_spad1) {
+    m.NewBvState(CONV_ACT_SRC_SPAD1, CONV_ACT_SRC_SPAD1_BITWIDTH);
+  }
+
 }
 
-void DefineReduceParam(Ila& m) {
+void DefineReduceParam(Ila& m, const ModelConfig& cfg) {
 
   m.NewBvState(REDUCTION_INPUT_BASE_ADDR, REDUCTION_INPUT_BASE_ADDR_BITWIDTH);
   m.NewBvState(REDUCTION_OUTPUT_BASE_ADDR, REDUCTION_OUTPUT_BASE_ADDR_BITWIDTH);
@@ -124,6 +136,12 @@ void DefineReduceParam(Ila& m) {
   
   m.NewBvState(REDUCTION_BIAS, REDUCTION_BIAS_BITWIDTH);
   m.NewBvState(REDUCTION_RELU_THRESHOLD, REDUCTION_RELU_THRESHOLD_BITWIDTH);
+
+  if (cfg.reduction_child) {
+    m.NewBvState(REDUCTION_ENABLE_BIAS, REDUCTION_ENABLE_BIAS_BITWIDTH);
+    m.NewBvState(REDUCTION_POOL_SIZE, REDUCTION_POOL_SIZE_BITWIDTH);
+    m.NewBvState(REDUCTION_POOL_AVG, REDUCTION_POOL_AVG_BITWIDTH);
+  }
 }
 
 
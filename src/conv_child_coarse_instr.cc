@@ -0,0 +1,365 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: conv_child_coarse_instr.cc
+
+// This file contains the coarse-grained conv child. Instead of scattering each
+// input pixel over the output map, it walks the output map and gathers all the
+// kernel positions of one output vector (for one input channel block) in a
+// single instruction. The kernel positions are visited in the same order as
+// the fine-grained child visits them, through the same uninterpreted functions,
+// thus the results in spad1 are bit-exact with Accel_Conv_Child.
+// With conv_output_stationary, the MAC sum is instead carried across the
+// channel blocks in a 32-bit register and spad1 is updated once per output
+// vector, after the last channel block.
+// An input pixel in and kernel index k hit the output o = in - k + K/2, and the
+// pair is visited only if in % stride == k % stride, i.e. (o - K/2) % stride == 0.
+// With conv_coarse_stride_loop, only those outputs are walked.
+// With conv_fused_pool, the finished output vectors are reduced into the psum
+// accumulator of their window instead, as the outputs of a window are finished
+// in row-major order, and only the pooled map is written to spad1.
+
+#include <ilang/ilang++.h>
+#include <hlscnn/hlscnn_top.h>
+#include <ilang/util/log.h>
+#include <vector>
+
+namespace ilang {
+namespace hlscnn {
+
+void DefineAccelConvChildCoarse(Ila& m, const ModelConfig& cfg) {
+  auto child = m.NewChild("Accel_Conv_Child_Coarse");
+  auto child_valid_flag = m.state(ACCEL_CONV_CHILD_VALID_FLAG);
+
+  // kernels larger than the unrolled loop are left to the fine-grained child
+  child.SetValid((child_valid_flag == ACCEL_CONV_CHILD_VALID) & ConvCoarseKernelFit(m));
+
+  // Declare child states
+  child.NewBvState(CONV_COARSE_FILTER_ID, CONV_COARSE_FILTER_ID_BITWIDTH);
+  child.NewBvState(CONV_COARSE_CHAN_BLOCK_ID, CONV_COARSE_CHAN_BLOCK_ID_BITWIDTH);
+  child.NewBvState(CONV_COARSE_OUT_ROW_ID, CONV_COARSE_OUT_ROW_ID_BITWIDTH);
+  child.NewBvState(CONV_COARSE_OUT_COL_ID, CONV_COARSE_OUT_COL_ID_BITWIDTH);
+  if (cfg.conv_output_stationary) {
+    child.NewBvState(CONV_COARSE_OUT_PSUM, CONV_COARSE_OUT_PSUM_BITWIDTH);
+  }
+  if (cfg.conv_fused_pool) {
+    child.NewMemState(CONV_COARSE_POOL_ACC, CONV_COARSE_POOL_ACC_ADDR_BITWIDTH,
+                      CONV_COARSE_POOL_ACC_DATA_BITWIDTH);
+  }
+
+  auto state = child.state(ACCEL_CONV_CHILD_STATE);
+  auto is_child_valid =
+    (child.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
+
+  auto filter_idx = child.state(CONV_COARSE_FILTER_ID);
+  auto chan_block = child.state(CONV_COARSE_CHAN_BLOCK_ID);
+  auto out_row = child.state(CONV_COARSE_OUT_ROW_ID);
+  auto out_col = child.state(CONV_COARSE_OUT_COL_ID);
+
+  // first output row/col and the step of the output loops
+  auto out_bitwidth = out_row.bit_width();
+  auto row_stride_ext = Concat(BvConst(0, out_bitwidth-CONV_KERNEL_R_STRIDE_BITWIDTH),
+                               child.state(CONV_KERNEL_R_STRIDE));
+  auto col_stride_ext = Concat(BvConst(0, out_bitwidth-CONV_KERNEL_C_STRIDE_BITWIDTH),
+                               child.state(CONV_KERNEL_C_STRIDE));
+  auto half_kern_row = Concat(BvConst(0, out_bitwidth-CONV_KERNEL_ROW_NUM_BITWIDTH),
+                              child.state(CONV_KERNEL_ROW_NUM)) / BvConst(2, out_bitwidth);
+  auto half_kern_col = Concat(BvConst(0, out_bitwidth-CONV_KERNEL_COL_NUM_BITWIDTH),
+                              child.state(CONV_KERNEL_COL_NUM)) / BvConst(2, out_bitwidth);
+
+  auto out_row_init = (cfg.conv_coarse_stride_loop) ?
+    URem(half_kern_row, row_stride_ext) : BvConst(0, out_bitwidth);
+  auto out_col_init = (cfg.conv_coarse_stride_loop) ?
+    URem(half_kern_col, col_stride_ext) : BvConst(0, out_bitwidth);
+  auto out_row_step = (cfg.conv_coarse_stride_loop) ? row_stride_ext : BvConst(1, out_bitwidth);
+  auto out_col_step = (cfg.conv_coarse_stride_loop) ? col_stride_ext : BvConst(1, out_bitwidth);
+
+  { // instr ---- start the output loops
+    auto instr = child.NewInstr("accel_conv_coarse_start");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_IDLE));
+
+    instr.SetUpdate(filter_idx, BvConst(0, CONV_COARSE_FILTER_ID_BITWIDTH));
+    instr.SetUpdate(chan_block, BvConst(0, CONV_COARSE_CHAN_BLOCK_ID_BITWIDTH));
+    instr.SetUpdate(out_row, out_row_init);
+    instr.SetUpdate(out_col, out_col_init);
+
+    instr.SetUpdate(state, BvConst(CONV_CHILD_STATE_COARSE_OUT_VEC,
+                                   ACCEL_CONV_CHILD_STATE_BITWIDTH));
+  }
+
+  { // instr ---- conv done
+    auto instr = child.NewInstr("accel_conv_coarse_done");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_DONE));
+
+    instr.SetUpdate(state,
+      BvConst(CONV_CHILD_STATE_IDLE, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+    instr.SetUpdate(child.state(ACCEL_CONV_CHILD_VALID_FLAG),
+      BvConst(ACCEL_CONV_CHILD_INVALID, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH));
+    if (cfg.spad_write_back) {
+      // ENABLE_WB: write the outputs back to the soc memory
+      SetSPADWriteBackStart(instr, m, child.state(CONV_ENABLE_WB) == 1,
+                            ConvOutSpad1Base(child, cfg.conv_act_spad1));
+    }
+  }
+
+  { // instr ---- compute one output vector for the current input channel block
+    auto instr = child.NewInstr("accel_conv_coarse_out_vec");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_COARSE_OUT_VEC));
+
+    auto ext_bitwidth = out_bitwidth;
+    // out_row and out_col should have the same bitwidth.
+    ILA_ASSERT(out_row.bit_width() == out_col.bit_width());
+
+    auto kernel_rows = child.state(CONV_KERNEL_ROW_NUM);
+    auto kernel_cols = child.state(CONV_KERNEL_COL_NUM);
+    auto input_rows = child.state(CONV_INPUT_ROW_NUM);
+    auto input_cols = child.state(CONV_INPUT_COL_NUM);
+
+    auto kernel_rows_ext = Concat(BvConst(0, ext_bitwidth-kernel_rows.bit_width()),
+                                  kernel_rows);
+    auto kernel_cols_ext = Concat(BvConst(0, ext_bitwidth-kernel_cols.bit_width()),
+                                  kernel_cols);
+    auto input_rows_ext = Concat(BvConst(0, ext_bitwidth-input_rows.bit_width()), input_rows);
+    auto input_cols_ext = Concat(BvConst(0, ext_bitwidth-input_cols.bit_width()), input_cols);
+
+    // input pixel hitting this output at each kernel row/col, and whether the
+    // fine-grained child would visit that (input pixel, kernel) pair: it skips
+    // the out-of-bound pairs (conv_out_of_bound) and only visits the kernel
+    // indices with the same remainder as the input index (kern_row_init).
+    std::vector<ExprRef> in_rows, in_cols, row_valid, col_valid;
+    for (auto k = 0; k < CONV_COARSE_MAX_KERNEL_SIZE; k++) {
+      auto k_ext = BvConst(k, ext_bitwidth);
+
+      auto in_row = out_row + k_ext - half_kern_row;
+      in_rows.push_back(in_row);
+      // the stride loop can start past a tiny output map
+      row_valid.push_back((out_row < input_rows_ext) & (k_ext < kernel_rows_ext) &
+                          (out_row + k_ext >= half_kern_row) &
+                          (in_row < input_rows_ext) &
+                          (URem(in_row, row_stride_ext) == URem(k_ext, row_stride_ext)));
+
+      auto in_col = out_col + k_ext - half_kern_col;
+      in_cols.push_back(in_col);
+      // the stride loop can start past a tiny output map
+      col_valid.push_back((out_col < input_cols_ext) & (k_ext < kernel_cols_ext) &
+                          (out_col + k_ext >= half_kern_col) &
+                          (in_col < input_cols_ext) &
+                          (URem(in_col, col_stride_ext) == URem(k_ext, col_stride_ext)));
+    }
+
+    // previous output activation, same lane as conv_child_dp_bias_relu
+    // OutActGetAddr with kernel at the center gives the address of out_row/col
+    auto out_addr = OutActGetAddr(child, out_row, out_col, half_kern_row, half_kern_col,
+                                  filter_idx);
+    auto spad1_out_base = ConvOutSpad1Base(child, cfg.conv_act_spad1);
+    auto spad1_base_addr = spad1_out_base + out_addr * NIC_MEM_ELEM_BYTEWIDTH;
+    auto spad1 = child.state(SCRATCH_PAD_1);
+
+    auto ofilter_idx = child.state(CONV_OFILTER_IDX);
+    auto wbact_idx = URem(ofilter_idx - 1, BvConst(CONV_VECTOR_SIZE, ofilter_idx.bit_width()));
+
+    auto oact = BvConst(0, ACT_TOTAL_BITWIDTH);
+    auto oacts = MemLoadActVector(spad1, spad1_base_addr);
+    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+      oact = Ite(wbact_idx == i, oacts[i], oact);
+    }
+
+    auto en_accum = child.state(CONV_ENABLE_ACCUM);
+    auto en_bias = child.state(CONV_ENABLE_BIAS);
+    auto en_relu = child.state(CONV_ENABLE_RELU);
+    auto chan_bias = child.state(CONV_CHAN_BIAS);
+
+    auto spad0 = child.state(SCRATCH_PAD_0);
+
+    auto is_written = BoolConst(false);
+
+    // output-stationary: MAC sum carried over from the previous channel blocks
+    auto out_psum = (cfg.conv_output_stationary) ?
+      Ite(chan_block == 0, BvConst(0, PSUM_TOTAL_BITWIDTH), child.state(CONV_COARSE_OUT_PSUM)) :
+      BvConst(0, PSUM_TOTAL_BITWIDTH);
+
+    // kernel rows outer, kernel cols inner, as the input pixels are visited
+    for (auto kr = 0; kr < CONV_COARSE_MAX_KERNEL_SIZE; kr++) {
+      for (auto kc = 0; kc < CONV_COARSE_MAX_KERNEL_SIZE; kc++) {
+        auto is_valid = row_valid[kr] & col_valid[kc];
+        auto k_row = BvConst(kr, CONV_CHILD_KERNEL_ROW_ID_BITWIDTH);
+        auto k_col = BvConst(kc, CONV_CHILD_KERNEL_COL_ID_BITWIDTH);
+
+        // same as accel_conv_child_act_fetch_activations and accel_conv_send_dp
+        auto act_addr = act_gen_get_addr(child, in_rows[kr], in_cols[kc], chan_block);
+        auto weight_req_addr = WtGetAddr(child, filter_idx, k_row, k_col, chan_block);
+        auto spad_addr_base = ConvWtSpad0Base(child, cfg.spad_double_buffer) +
+                              weight_req_addr * (NIC_MEM_ELEM_BYTEWIDTH/2);
+
+        // same as conv_child_dp_mac_psum
+        auto mac_psum = (cfg.conv_output_stationary) ? out_psum : BvConst(0, PSUM_TOTAL_BITWIDTH);
+        auto acts = ConvLoadActVector(child, act_addr, CONV_VECTOR_SIZE, cfg.conv_act_spad1);
+        auto wt_bytes = MemLoadBytes(spad0, spad_addr_base, CONV_VECTOR_SIZE);
+        for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+          auto act = acts[i];
+          auto weight = Concat(wt_bytes[i], BvConst(0, SCRATCH_PAD_DATA_BITWIDTH));
+          std::vector<ExprRef> conv_mac_in = {mac_psum, weight, act};
+          mac_psum = ConvMac(conv_mac_in);
+        }
+        is_written = is_written | is_valid;
+
+        if (cfg.conv_output_stationary) {
+          out_psum = Ite(is_valid, mac_psum, out_psum);
+          continue;
+        }
+
+        auto psum_val = ConvMacPsum2Act(mac_psum);
+
+        // same as conv_child_dp_bias_relu
+        auto is_first_psum = (kr == 0 && kc == 0) ? (chan_block == 0) : BoolConst(false);
+        auto oact_out = Ite(is_first_psum & (en_accum == 0),
+                            ActAdd2Psum(psum_val, BvConst(0, ACT_TOTAL_BITWIDTH)),
+                            ActAdd2Psum(psum_val, oact));
+
+        auto is_last_psum = WtIsLastPsum(child, out_row, out_col, k_row, k_col, chan_block);
+        oact_out = Ite(is_last_psum & (en_bias != 0),
+                       ConvAddBias(oact_out, chan_bias), oact_out);
+        oact_out = Ite(is_last_psum & (en_relu != 0), PsumRelu(oact_out), oact_out);
+
+        oact = Ite(is_valid, Psum2Act(oact_out), oact);
+      }
+    }
+
+    // incrementing the loop params: filter -> out row -> out col -> chan block
+    auto num_filters = child.state(CONV_OFILTER_IDX);
+    auto num_filters_ext = Concat(BvConst(0, filter_idx.bit_width() - num_filters.bit_width()),
+                                  num_filters);
+    auto last_chan_block = ConvLastChanBlock(child);
+    auto last_chan_blk_ext = Concat(BvConst(0, chan_block.bit_width()-last_chan_block.bit_width()),
+                                    last_chan_block);
+
+    auto is_last_chan_blk = (chan_block >= last_chan_blk_ext - 1);
+    auto is_last_col = is_last_chan_blk & (out_col + out_col_step >= input_cols_ext);
+    auto is_last_row = is_last_col & (out_row + out_row_step >= input_rows_ext);
+    auto is_last_filter = is_last_row & (filter_idx >= num_filters_ext - 1);
+
+    if (cfg.conv_output_stationary) {
+      // finish the output vector after its last channel block: round the MAC
+      // sum once, then accumulate/bias/relu as conv_child_dp_bias_relu does
+      instr.SetUpdate(child.state(CONV_COARSE_OUT_PSUM), out_psum);
+
+      // the unpooled outputs are not in spad1 to accumulate on when pooling
+      auto no_accum = (cfg.conv_fused_pool) ?
+        (en_accum == 0) | (child.state(CONV_POOL_SIZE) > 1) : (en_accum == 0);
+
+      auto psum_val = ConvMacPsum2Act(out_psum);
+      auto oact_out = Ite(no_accum,
+                          ActAdd2Psum(psum_val, BvConst(0, ACT_TOTAL_BITWIDTH)),
+                          ActAdd2Psum(psum_val, oact));
+      oact_out = Ite(en_bias != 0, ConvAddBias(oact_out, chan_bias), oact_out);
+      oact_out = Ite(en_relu != 0, PsumRelu(oact_out), oact_out);
+
+      oact = Psum2Act(oact_out);
+      is_written = is_written & is_last_chan_blk;
+    }
+
+    if (cfg.conv_fused_pool) {
+      // reduce the finished output into the accumulator of its window
+      auto pool_size = Concat(BvConst(0, ext_bitwidth-CONV_POOL_SIZE_BITWIDTH),
+                              child.state(CONV_POOL_SIZE));
+      auto is_pool = (pool_size > 1);
+      auto pool_div = Ite(is_pool, pool_size, BvConst(1, ext_bitwidth));
+
+      auto pool_row = out_row / pool_div;
+      auto pool_col = out_col / pool_div;
+      auto pool_rows = input_rows_ext / pool_div;
+      auto pool_cols = input_cols_ext / pool_div;
+      auto is_win_first = (URem(out_row, pool_div) == 0) & (URem(out_col, pool_div) == 0);
+      auto is_win_last = (URem(out_row, pool_div) == pool_div - 1) &
+                         (URem(out_col, pool_div) == pool_div - 1);
+
+      // the pooled map has the layout of the output map, with the pooled sizes
+      auto addr_bitwidth = spad1_base_addr.bit_width();
+      auto filter_idx_ext = Concat(BvConst(0, addr_bitwidth-filter_idx.bit_width()), filter_idx);
+      auto pool_row_ext = Concat(BvConst(0, addr_bitwidth-ext_bitwidth), pool_row);
+      auto pool_col_ext = Concat(BvConst(0, addr_bitwidth-ext_bitwidth), pool_col);
+      auto pool_rows_ext = Concat(BvConst(0, addr_bitwidth-ext_bitwidth), pool_rows);
+      auto pool_cols_ext = Concat(BvConst(0, addr_bitwidth-ext_bitwidth), pool_cols);
+      auto pool_elems = Concat(BvConst(0, addr_bitwidth-ext_bitwidth), pool_div * pool_div);
+
+      auto pool_addr = spad1_out_base +
+        ((filter_idx_ext * pool_rows_ext * pool_cols_ext +
+          pool_row_ext * pool_cols_ext + pool_col_ext) *
+         CONV_VECTOR_SIZE * (ACT_TOTAL_BITWIDTH/8));
+
+      // the window max or sum is kept in the psum type as in the reduction
+      // child, and the average is divided and rounded once at the last output
+      auto pool_acc = child.state(CONV_COARSE_POOL_ACC);
+      auto acc_addr = Extract(pool_col, CONV_COARSE_POOL_ACC_ADDR_BITWIDTH - 1, 0);
+      auto acc_old = Load(pool_acc, acc_addr);
+      auto is_avg = (child.state(CONV_POOL_AVG) == 1);
+      auto psum_zero = BvConst(0, PSUM_TOTAL_BITWIDTH);
+      auto acc_new = Ite(is_win_first, ReduceAddPsum(psum_zero, oact),
+                         Ite(is_avg, ReduceAddPsum(acc_old, oact), ReduceMaxPsum(acc_old, oact)));
+      auto is_pooled = is_pool & is_written;
+      instr.SetUpdate(pool_acc, Store(pool_acc, acc_addr, Ite(is_pooled, acc_new, acc_old)));
+      auto pool_out = Psum2Act(Ite(is_avg, ReduceAvgPsum(acc_new, pool_elems), acc_new));
+
+      oact = Ite(is_pool, pool_out, oact);
+      spad1_base_addr = Ite(is_pool, pool_addr, spad1_base_addr);
+      // the pooled output is written at the last output of its window, the
+      // outputs past the last whole window are dropped
+      is_written = is_written & (~is_pool | (is_win_last & (pool_row < pool_rows) &
+                                              (pool_col < pool_cols)));
+    }
+
+    // same as conv_child_output, the other lanes of out_array are always zero.
+    // The vector is left untouched if no input pixel hits it.
+    auto spad1_olds = MemLoadActVector(spad1, spad1_base_addr);
+    std::vector<ExprRef> outs;
+    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+      auto out_element = Ite(wbact_idx == i, oact, BvConst(0, ACT_TOTAL_BITWIDTH));
+      outs.push_back(Ite(is_written, out_element, spad1_olds[i]));
+    }
+    instr.SetUpdate(spad1, MemStoreActVector(spad1, spad1_base_addr, outs));
+
+    auto next_chan_block = Ite(is_last_chan_blk,
+                               BvConst(0, chan_block.bit_width()), chan_block + 1);
+    auto next_out_col = Ite(is_last_col, out_col_init,
+                            Ite(is_last_chan_blk, out_col + out_col_step, out_col));
+    auto next_out_row = Ite(is_last_row, out_row_init,
+                            Ite(is_last_col, out_row + out_row_step, out_row));
+    auto next_filter_id = Ite(is_last_filter, BvConst(0, filter_idx.bit_width()),
+                              Ite(is_last_row, filter_idx + 1, filter_idx));
+
+    instr.SetUpdate(chan_block, next_chan_block);
+    instr.SetUpdate(out_col, next_out_col);
+    instr.SetUpdate(out_row, next_out_row);
+    instr.SetUpdate(filter_idx, next_filter_id);
+
+    auto next_state =
+      Ite(is_last_filter,
+          BvConst(CONV_CHILD_STATE_DONE, ACCEL_CONV_CHILD_STATE_BITWIDTH),
+          BvConst(CONV_CHILD_STATE_COARSE_OUT_VEC, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+    instr.SetUpdate(state, next_state);
+  }
+}
+
+} // hlscnn
+} // ilang
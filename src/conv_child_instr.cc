@@ -27,20 +27,47 @@
 #include <ilang/ilang++.h>
 #include <hlscnn/hlscnn_top.h>
 #include <ilang/util/log.h>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace ilang {
 namespace hlscnn {
 
-void DefineConvActFetch(Ila& child);
-void DefineConvWeightFetch(Ila& child);
-void DefineConvDatapath(Ila& child);
-
-void DefineAccelConvChild(Ila& m) {
+void DefineConvActFetch(Ila& child, const ModelConfig& cfg);
+void DefineConvWeightFetch(Ila& child, const ModelConfig& cfg);
+void DefineConvDatapath(Ila& child, const ModelConfig& cfg);
+
+// datapath stages shared by the seperated and the fused datapath instructions
+std::vector<ExprRef> ConvDpGetWeights(const Ila& child, const ModelConfig& cfg);
+std::vector<ExprRef> ConvDpLoadWeights(const Ila& child, const ExprRef& filter_idx,
+                                       const ModelConfig& cfg);
+ExprRef ConvDpExpandWeight(const ExprRef& wt_byte, const ModelConfig& cfg);
+ExprRef ConvDpMacPsum(const std::vector<ExprRef>& weights, const std::vector<ExprRef>& acts,
+                      const ModelConfig& cfg);
+ExprRef ConvDpSpad1Addr(const Ila& child, const ModelConfig& cfg);
+ExprRef ConvDpBiasRelu(const Ila& child, const ExprRef& psum_val, const ExprRef& oact_element,
+                       const ModelConfig& cfg);
+ConvDpFuncs GetConvDpFuncs(const ModelConfig& cfg);
+// the spad0 weight bytes of filter_idx at the current kernel position and channel block
+std::vector<ExprRef> ConvLoadWeightBytes(const Ila& child, const ExprRef& filter_idx,
+                                         const ModelConfig& cfg);
+
+// channel block range of the current filter
+ExprRef ConvChildFirstChanBlock(const Ila& child, const ModelConfig& cfg);
+ExprRef ConvChildLastChanBlock(const Ila& child, const ModelConfig& cfg);
+
+void DefineAccelConvChild(Ila& m, const ModelConfig& cfg) {
   auto child = m.NewChild("Accel_Conv_Child");
+  auto lanes = cfg.conv_lanes;
   auto child_valid_flag = m.state(ACCEL_CONV_CHILD_VALID_FLAG);
   
-  child.SetValid(child_valid_flag == ACCEL_CONV_CHILD_VALID);
+  if (cfg.conv_child_coarse) {
+    // only the kernels that don't fit in the coarse-grained child run here
+    child.SetValid((child_valid_flag == ACCEL_CONV_CHILD_VALID) & ~ConvCoarseKernelFit(m));
+  } else {
+    child.SetValid(child_valid_flag == ACCEL_CONV_CHILD_VALID);
+  }
 
   // Declare child states
   child.NewBvState(CONV_CHILD_FILTER_ID, CONV_CHILD_FILTER_ID_BITWIDTH);
@@ -52,38 +79,74 @@ void DefineAccelConvChild(Ila& m) {
 
   child.NewBvState(CONV_CHILD_KERNEL_COL_ID, CONV_CHILD_KERNEL_COL_ID_BITWIDTH);
   child.NewBvState(CONV_CHILD_KERNEL_ROW_ID, CONV_CHILD_KERNEL_ROW_ID_BITWIDTH);
+  if (cfg.conv_analytic_kernel_bounds) {
+    child.NewBvState(CONV_CHILD_KERNEL_ROW_LAST, CONV_CHILD_KERNEL_ROW_LAST_BITWIDTH);
+    child.NewBvState(CONV_CHILD_KERNEL_COL_FIRST, CONV_CHILD_KERNEL_COL_FIRST_BITWIDTH);
+    child.NewBvState(CONV_CHILD_KERNEL_COL_LAST, CONV_CHILD_KERNEL_COL_LAST_BITWIDTH);
+  }
 
   child.NewBvState(CONV_CHILD_WEIGHT_ADDR, CONV_CHILD_WEIGHT_ADDR_BITWIDTH);
+  if (cfg.conv_weight_cache) {
+    child.NewMemState(CONV_CHILD_WEIGHT_CACHE, CONV_CHILD_WEIGHT_CACHE_ADDR_BITWIDTH,
+                      lanes * SCRATCH_PAD_DATA_BITWIDTH);
+  }
 
-  child.NewBvState(CONV_CHILD_ACTIVATION_PSUM, CONV_CHILD_ACTIVATION_PSUM_BITWIDTH);
+  // the element bitwidths of the arrays follow the bitwidth profile
+  child.NewBvState(CONV_CHILD_ACTIVATION_PSUM, cfg.conv_act_bits);
   
   child.NewBvState(CONV_CHILD_ACT_REQ_LENGTH, CONV_CHILD_ACT_REQ_LENGTH_BITWIDTH);
   child.NewBvState(CONV_CHILD_ACT_FETCH_CNTR, CONV_CHILD_ACT_FETCH_CNTR_BITWIDTH);
+  if (cfg.axi_master_outstanding > 0) {
+    child.NewBvState(CONV_CHILD_ACT_ISSUE_CNTR, CONV_CHILD_ACT_ISSUE_CNTR_BITWIDTH);
+  }
+  if (cfg.conv_zero_skip) {
+    child.NewBvState(CONV_CHILD_ACT_VEC_CNTR, CONV_CHILD_ACT_VEC_CNTR_BITWIDTH);
+    child.NewBvState(CONV_CHILD_ZERO_SKIP_CNTR, CONV_CHILD_ZERO_SKIP_CNTR_BITWIDTH);
+  }
   
-  for (int i = 0; i < CONV_VECTOR_SIZE; i++) {
+  for (int i = 0; i < lanes; i++) {
     // act array
     auto act_v_name = GetStateName(CONV_CHILD_ACT_ARRAY, i);
-    child.NewBvState(act_v_name, CONV_CHILD_ACT_ARRAY_BITWIDTH);
+    child.NewBvState(act_v_name, cfg.conv_act_bits);
     // weight array
     auto weight_v_name = GetStateName(CONV_CHILD_WEIGHT_ARRAY, i);
-    child.NewBvState(weight_v_name, CONV_CHILD_WEIGHT_ARRAY_BITWIDTH);
+    child.NewBvState(weight_v_name, cfg.conv_weight_bits);
     // oact array
     auto oact_v_name = GetStateName(CONV_CHILD_O_ACT_ARRAY, i);
-    child.NewBvState(oact_v_name, CONV_CHILD_O_ACT_ARRAY_BITWIDTH);
+    child.NewBvState(oact_v_name, cfg.conv_act_bits);
     // out array
     auto out_v_name = GetStateName(CONV_CHILD_OUT_ARRAY, i);
-    child.NewBvState(out_v_name, CONV_CHILD_OUT_ARRAY_BITWIDTH);
+    child.NewBvState(out_v_name, cfg.conv_act_bits);
   }
   
+  { // instr ---- conv done 
+    // defined here as the write-back child is started from the parent
+    auto state = child.state(ACCEL_CONV_CHILD_STATE);
+    auto is_child_valid = (child_valid_flag == ACCEL_CONV_CHILD_VALID);
+    auto instr = child.NewInstr("accel_conv_done");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_DONE));
+
+    instr.SetUpdate(state, 
+      BvConst(CONV_CHILD_STATE_IDLE, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+    instr.SetUpdate(child_valid_flag,
+      BvConst(ACCEL_CONV_CHILD_INVALID, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH));
+    if (cfg.spad_write_back) {
+      // ENABLE_WB: write the outputs back to the soc memory
+      SetSPADWriteBackStart(instr, m, child.state(CONV_ENABLE_WB) == 1,
+                            ConvOutSpad1Base(child, cfg.conv_act_spad1));
+    }
+  }
+
   // Declare child instructions, seperating activation fetching, weigth fetching 
   // and datapath
-  DefineConvActFetch(child);
-  DefineConvWeightFetch(child);
-  DefineConvDatapath(child);  
+  DefineConvActFetch(child, cfg);
+  DefineConvWeightFetch(child, cfg);
+  DefineConvDatapath(child, cfg);
 }
 
-void DefineConvActFetch(Ila& child) {
+void DefineConvActFetch(Ila& child, const ModelConfig& cfg) {
   
+  auto lanes = cfg.conv_lanes;
   auto state = child.state(ACCEL_CONV_CHILD_STATE);
   auto is_child_valid = 
     (child.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
@@ -95,6 +158,14 @@ void DefineConvActFetch(Ila& child) {
   auto input_col = child.state(CONV_CHILD_INPUT_COL_ID);
   auto input_col_loop = child.state(CONV_CHILD_INPUT_COL_ID_LOOP);
 
+  // a new filter/channel block pair starts by filling the weight cache, the
+  // kernel row/col ids are used as fill indices (weight_init resets them).
+  auto next_pair_state = (cfg.conv_weight_cache) ?
+    BvConst(CONV_CHILD_STATE_WEIGHT_CACHE_FILL, ACCEL_CONV_CHILD_STATE_BITWIDTH) :
+    BvConst(CONV_CHILD_STATE_ACT_SET_REQ_LEN, ACCEL_CONV_CHILD_STATE_BITWIDTH);
+  auto kern_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
+  auto kern_col = child.state(CONV_CHILD_KERNEL_COL_ID);
+
   { // instr ---- start Activation fetching
     // initilizting the loop parameter, setting them to zero, thus the next state should
     // jump to weight fetching
@@ -107,33 +178,34 @@ void DefineConvActFetch(Ila& child) {
     instr.SetUpdate(input_col_loop, BvConst(0, CONV_CHILD_INPUT_COL_ID_LOOP_BITWIDTH));
 
     //TODO: at the start, the next state should directly jump to the weight fetching!
-    auto next_state = BvConst(CONV_CHILD_STATE_ACT_SET_REQ_LEN,
-                              ACCEL_CONV_CHILD_STATE_BITWIDTH);
+    auto next_state = next_pair_state;
+    if (cfg.conv_weight_cache) {
+      instr.SetUpdate(kern_row, BvConst(0, CONV_CHILD_KERNEL_ROW_ID_BITWIDTH));
+      instr.SetUpdate(kern_col, BvConst(0, CONV_CHILD_KERNEL_COL_ID_BITWIDTH));
+    }
+    if (cfg.conv_zero_skip) {
+      instr.SetUpdate(child.state(CONV_CHILD_ACT_VEC_CNTR), 
+                      BvConst(0, CONV_CHILD_ACT_VEC_CNTR_BITWIDTH));
+      instr.SetUpdate(child.state(CONV_CHILD_ZERO_SKIP_CNTR), 
+                      BvConst(0, CONV_CHILD_ZERO_SKIP_CNTR_BITWIDTH));
+    }
     // reset the out_array
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+    for (auto i = 0; i < lanes; i++) {
       instr.SetUpdate(child.state(GetStateName(CONV_CHILD_OUT_ARRAY, i)), 
-                      BvConst(0, CONV_CHILD_OUT_ARRAY_BITWIDTH));
+                      BvConst(0, cfg.conv_act_bits));
     }
     
     instr.SetUpdate(state, next_state);
   }
 
-  { // instr ---- conv done 
-    auto instr = child.NewInstr("accel_conv_done");
-    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_DONE));
-
-    instr.SetUpdate(state, 
-      BvConst(CONV_CHILD_STATE_IDLE, ACCEL_CONV_CHILD_STATE_BITWIDTH));
-    instr.SetUpdate(child.state(ACCEL_CONV_CHILD_VALID_FLAG),
-      BvConst(ACCEL_CONV_CHILD_INVALID, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH));
-  }
-
   { // instr ---- setting filter_idx
     // incrementing filter_idx, or conv done
     auto instr = child.NewInstr("accel_conv_child_act_filter_idx");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_ACT_FILTER_ID));
 
-    auto num_filters = child.state(CONV_OFILTER_IDX);
+    // with multiple filters per pass, filter_idx is the filter group id
+    auto num_filters = (cfg.conv_multi_filter) ?
+      ConvLastFilterGroup(child, lanes) : child.state(CONV_OFILTER_IDX);
     auto num_filters_ext = Concat(BvConst(0, filter_idx.bit_width() - num_filters.bit_width()),
                                   num_filters);
 
@@ -143,10 +215,18 @@ void DefineConvActFetch(Ila& child) {
     auto next_state = 
       Ite(filter_idx >= num_filters_ext - 1,
             BvConst(CONV_CHILD_STATE_DONE, ACCEL_CONV_CHILD_STATE_BITWIDTH),
-            BvConst(CONV_CHILD_STATE_ACT_SET_REQ_LEN, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+            next_pair_state);
 
     instr.SetUpdate(filter_idx, next_filter_id);
     instr.SetUpdate(state, next_state);
+    if (cfg.conv_grouped) {
+      // the next filter starts from the first channel block of its group
+      instr.SetUpdate(chan_block, ConvFilterFirstChanBlock(child, next_filter_id, lanes));
+    }
+    if (cfg.conv_weight_cache) {
+      instr.SetUpdate(kern_row, BvConst(0, CONV_CHILD_KERNEL_ROW_ID_BITWIDTH));
+      instr.SetUpdate(kern_col, BvConst(0, CONV_CHILD_KERNEL_COL_ID_BITWIDTH));
+    }
   }
 
   { // instr ---- incrementing input channel block id
@@ -154,26 +234,22 @@ void DefineConvActFetch(Ila& child) {
     instr.SetDecode(is_child_valid &
                     (state == CONV_CHILD_STATE_ACT_INPUT_CHANNEL_BLOCK));
 
-    // last_channel_block = frac_ceil(input_channels, channel_block_size);
-    auto input_channels = child.state(CONV_INPUT_CHAN_NUM);
-    auto chan_block_size = BvConst(CHANNEL_BLOCK_SIZE, input_channels.bit_width());
-    auto last_chan_block = 
-      Ite(URem(input_channels, chan_block_size) == 0,
-          input_channels / chan_block_size, input_channels / chan_block_size + 1);
-    
-    auto last_chan_blk_ext = Concat(BvConst(0, chan_block.bit_width()-last_chan_block.bit_width()),
-                                    last_chan_block);
+    auto last_chan_blk_id = ConvChildLastChanBlock(child, cfg);
     
-    auto next_chan_block = Ite(chan_block >= last_chan_blk_ext - 1,
+    auto next_chan_block = Ite(chan_block >= last_chan_blk_id,
                                BvConst(0, chan_block.bit_width()), chan_block + 1);
     // update 08232020: FSM next state fixed
     auto next_state = 
-      Ite(chan_block >= last_chan_blk_ext - 1,
+      Ite(chan_block >= last_chan_blk_id,
           BvConst(CONV_CHILD_STATE_ACT_FILTER_ID, ACCEL_CONV_CHILD_STATE_BITWIDTH),
-          BvConst(CONV_CHILD_STATE_ACT_SET_REQ_LEN, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+          next_pair_state);
   
     instr.SetUpdate(chan_block, next_chan_block);
     instr.SetUpdate(state, next_state);
+    if (cfg.conv_weight_cache) {
+      instr.SetUpdate(kern_row, BvConst(0, CONV_CHILD_KERNEL_ROW_ID_BITWIDTH));
+      instr.SetUpdate(kern_col, BvConst(0, CONV_CHILD_KERNEL_COL_ID_BITWIDTH));
+    }
   }
 
   { // instr ---- incrementing input row id
@@ -240,6 +316,10 @@ void DefineConvActFetch(Ila& child) {
     
     instr.SetUpdate(req_len, req_len_next);
     instr.SetUpdate(act_fetch_cntr, act_fetch_cntr_next);
+    if (cfg.axi_master_outstanding > 0) {
+      instr.SetUpdate(child.state(CONV_CHILD_ACT_ISSUE_CNTR),
+                      BvConst(0, CONV_CHILD_ACT_ISSUE_CNTR_BITWIDTH));
+    }
 
     auto next_state = BvConst(CONV_CHILD_STATE_ACT_FETCH_ACT,
                               ACCEL_CONV_CHILD_STATE_BITWIDTH);
@@ -247,10 +327,32 @@ void DefineConvActFetch(Ila& child) {
     instr.SetUpdate(state, next_state);
   }
 
+  if (cfg.axi_master_outstanding > 0) { // instr ---- requesting the act vectors of the burst
+    // the requests run ahead of the fetch while the burst is in the weight and
+    // datapath states, up to the req_len vectors of the burst
+    auto instr = child.NewInstr("accel_conv_child_act_rd_req");
+    auto issue_cntr = child.state(CONV_CHILD_ACT_ISSUE_CNTR);
+    auto req_len = Extract(child.state(CONV_CHILD_ACT_REQ_LENGTH), issue_cntr.bit_width() - 1, 0);
+    auto is_in_burst = (state == CONV_CHILD_STATE_ACT_FETCH_ACT) |
+                       ((state >= CONV_CHILD_STATE_WEIGHT_INIT) & (state <= CONV_CHILD_STATE_OUT));
+    instr.SetDecode(is_child_valid & is_in_burst & (issue_cntr < req_len) &
+                    AXIMasterRdReqReady(child, cfg));
+
+    auto act_addr = act_gen_get_addr(child, input_row, input_col_loop + issue_cntr, chan_block,
+                                     lanes, cfg.conv_act_bits);
+    SetAXIMasterRdReq(instr, child, cfg, act_addr, AXI_MASTER_RD_SRC_CONV_ACT);
+    instr.SetUpdate(issue_cntr, issue_cntr + 1);
+  }
+
   { // instr ---- fetching activations from external memory
     // Use an internal memory to simulate the external memory
     auto instr = child.NewInstr("accel_conv_child_act_fetch_activations");
-    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_ACT_FETCH_ACT));
+    auto is_decode = is_child_valid & (state == CONV_CHILD_STATE_ACT_FETCH_ACT);
+    if (cfg.axi_master_outstanding > 0) {
+      // wait for the response of the vector
+      is_decode = is_decode & AXIMasterRdRespValid(child, cfg, AXI_MASTER_RD_SRC_CONV_ACT);
+    }
+    instr.SetDecode(is_decode);
 
     auto cntr = child.state(CONV_CHILD_ACT_FETCH_CNTR);
     // update 08232020: the real input_col id is here
@@ -260,29 +362,68 @@ void DefineConvActFetch(Ila& child) {
     // fetch the activation from internal memory
     //channel_block_address = base_addr + ((channel_block_idx*input_rows*input_cols*CHANNEL_BLOCK_SIZE) 
     // + in_row*(input_cols*CHANNEL_BLOCK_SIZE) + in_col*CHANNEL_BLOCK_SIZE)*(ACTIVATION_TOT_WIDTH/8);
-    auto act_addr = act_gen_get_addr(child, input_row, input_col_next, chan_block);
-    instr.SetUpdate(child.state(TOP_MASTER_RD_ADDR_OUT), act_addr);
+    auto act_addr = act_gen_get_addr(child, input_row, input_col_next, chan_block, lanes,
+                                     cfg.conv_act_bits);
 
-    auto vir_mem = child.state(VIRTUAL_SOC_MEMORY);
     // for vir memory access no need to add the activation base
     // TODO: Revert the subtraction of activation base value here
     // act_addr = act_addr - child.state(CONV_ACT_BASE);
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+    auto is_zero_vec = BoolConst(true);
+    std::vector<ExprRef> acts;
+    if (cfg.axi_master_outstanding > 0) {
+      // the address was sent by accel_conv_child_act_rd_req
+      auto resp = AXIMasterRdRespData(child, cfg);
+      for (auto i = 0; i < lanes; i++) {
+        acts.push_back(Extract(resp, cfg.conv_act_bits*(i+1) - 1, cfg.conv_act_bits*i));
+      }
+      SetAXIMasterRdResp(instr, child, cfg);
+    } else {
+      instr.SetUpdate(child.state(TOP_MASTER_RD_ADDR_OUT), act_addr);
+      acts = ConvLoadActVector(child, act_addr, lanes, cfg.conv_act_spad1, cfg.conv_act_bits);
+    }
+    for (auto i = 0; i < lanes; i++) {
       auto elem = child.state(GetStateName(CONV_CHILD_ACT_ARRAY, i));
-      auto act_byte_0 = Load(vir_mem, act_addr + 2*i);
-      auto act_byte_1 = Load(vir_mem, act_addr + 2*i + 1);
-      instr.SetUpdate(elem, Concat(act_byte_1, act_byte_0));
+      instr.SetUpdate(elem, acts[i]);
+      is_zero_vec = is_zero_vec & (acts[i] == 0);
     }
     
     auto next_state = BvConst(CONV_CHILD_STATE_WEIGHT_INIT,
                               ACCEL_CONV_CHILD_STATE_BITWIDTH);
 
+    if (cfg.conv_zero_skip) {
+      // a zero vector adds nothing to the psums, but the MAC steps of the first
+      // channel block may also reset the psum, and those of the last one write
+      // the final output vector (bias/relu, and zeros in the other lanes)
+      auto is_first_blk_reset = (chan_block == ConvChildFirstChanBlock(child, cfg)) & 
+                                (child.state(CONV_ENABLE_ACCUM) == 0);
+      auto is_last_blk = (chan_block == ConvChildLastChanBlock(child, cfg));
+      auto is_skip = is_zero_vec & ~is_first_blk_reset & ~is_last_blk;
+
+      // same as the end of the kernel loop in accel_conv_child_weight_row_id
+      auto req_len = Extract(child.state(CONV_CHILD_ACT_REQ_LENGTH), cntr.bit_width() - 1, 0);
+      auto last_act_req = (cntr >= req_len - 1);
+      instr.SetUpdate(cntr, Ite(is_skip, cntr + 1, cntr));
+
+      next_state = 
+        Ite(is_skip,
+          Ite(last_act_req,
+              BvConst(CONV_CHILD_STATE_ACT_INPUT_COL, ACCEL_CONV_CHILD_STATE_BITWIDTH),
+              BvConst(CONV_CHILD_STATE_ACT_FETCH_ACT, ACCEL_CONV_CHILD_STATE_BITWIDTH)),
+          next_state);
+
+      auto vec_cntr = child.state(CONV_CHILD_ACT_VEC_CNTR);
+      auto skip_cntr = child.state(CONV_CHILD_ZERO_SKIP_CNTR);
+      instr.SetUpdate(vec_cntr, vec_cntr + 1);
+      instr.SetUpdate(skip_cntr, Ite(is_skip, skip_cntr + 1, skip_cntr));
+    }
+
     instr.SetUpdate(state, next_state);    
   }
 }
 
-void DefineConvWeightFetch(Ila& child) {
+void DefineConvWeightFetch(Ila& child, const ModelConfig& cfg) {
   
+  auto lanes = cfg.conv_lanes;
   auto state = child.state(ACCEL_CONV_CHILD_STATE);
   auto is_child_valid = 
         (child.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
@@ -292,8 +433,6 @@ void DefineConvWeightFetch(Ila& child) {
   auto row_stride = child.state(CONV_KERNEL_R_STRIDE);
   auto col_stride = child.state(CONV_KERNEL_C_STRIDE);
 
-  auto filter_idx = child.state(CONV_CHILD_FILTER_ID);
-  auto chan_block = child.state(CONV_CHILD_CHAN_BLOCK_ID);
   auto act_row = child.state(CONV_CHILD_INPUT_ROW_ID);
   auto act_col = child.state(CONV_CHILD_INPUT_COL_ID);
 
@@ -303,21 +442,93 @@ void DefineConvWeightFetch(Ila& child) {
   auto kern_row_init = Extract(URem(act_row, row_stride_ext), kern_row.bit_width()-1, 0);
   auto kern_col_init = Extract(URem(act_col, col_stride_ext), kern_col.bit_width()-1, 0);
 
+  if (cfg.conv_weight_cache) { // instr ---- fill one entry of the weight cache
+    auto instr = child.NewInstr("accel_conv_child_weight_cache_fill");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_CACHE_FILL));
+
+    auto wt_bytes = ConvLoadWeightBytes(child, child.state(CONV_CHILD_FILTER_ID), cfg);
+    auto entry = wt_bytes[0];
+    for (auto i = 1; i < lanes; i++) {
+      entry = Concat(wt_bytes[i], entry);
+    }
+    auto cache = child.state(CONV_CHILD_WEIGHT_CACHE);
+    instr.SetUpdate(cache, Store(cache, ConvWeightCacheAddr(child), entry));
+
+    auto last_kern_row = child.state(CONV_KERNEL_ROW_NUM);
+    auto last_kern_col = child.state(CONV_KERNEL_COL_NUM);
+    auto last_kern_row_ext = Concat(BvConst(0, kern_row.bit_width()-last_kern_row.bit_width()),
+                                    last_kern_row);
+    auto last_kern_col_ext = Concat(BvConst(0, kern_col.bit_width()-last_kern_col.bit_width()),
+                                    last_kern_col);
+
+    auto is_last_col = (kern_col + 1 >= last_kern_col_ext);
+    auto is_last_row = is_last_col & (kern_row + 1 >= last_kern_row_ext);
+
+    auto next_kern_col = Ite(is_last_col, BvConst(0, kern_col.bit_width()), kern_col + 1);
+    auto next_kern_row = Ite(is_last_row, BvConst(0, kern_row.bit_width()),
+                             Ite(is_last_col, kern_row + 1, kern_row));
+    auto next_state =
+      Ite(is_last_row,
+          BvConst(CONV_CHILD_STATE_ACT_SET_REQ_LEN, ACCEL_CONV_CHILD_STATE_BITWIDTH),
+          BvConst(CONV_CHILD_STATE_WEIGHT_CACHE_FILL, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+
+    instr.SetUpdate(kern_col, next_kern_col);
+    instr.SetUpdate(kern_row, next_kern_row);
+    instr.SetUpdate(state, next_state);
+  }
+
   { // instr ---- initializing the weight fetching parameters
     // this part setting the kern_row and kern_col to zero, thus the next state should jump to
     // check out-of-bound, no need to increment the loop param for this one
     auto instr = child.NewInstr("accel_conv_child_weight_init");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_INIT));
 
-    instr.SetUpdate(kern_row, kern_row_init);
-    instr.SetUpdate(kern_col, kern_col_init);
-
-    auto next_state = BvConst(CONV_CHILD_STATE_WEIGHT_CHECK_BOUND,
-                              ACCEL_CONV_CHILD_STATE_BITWIDTH);
-    
-    instr.SetUpdate(state, next_state);
+    if (cfg.conv_analytic_kernel_bounds) {
+      // compute the live kernel window of this input pixel at once, the loop
+      // below then only visits the positions that pass the bound check.
+      auto row_win = conv_kernel_window(act_row, child.state(CONV_KERNEL_ROW_NUM),
+                                        child.state(CONV_INPUT_ROW_NUM), row_stride);
+      auto col_win = conv_kernel_window(act_col, child.state(CONV_KERNEL_COL_NUM),
+                                        child.state(CONV_INPUT_COL_NUM), col_stride);
+      auto is_empty = row_win.is_empty | col_win.is_empty;
+
+      auto kern_row_last = child.state(CONV_CHILD_KERNEL_ROW_LAST);
+      auto kern_col_first = child.state(CONV_CHILD_KERNEL_COL_FIRST);
+      auto kern_col_last = child.state(CONV_CHILD_KERNEL_COL_LAST);
+      auto kern_bw = kern_row.bit_width();
+
+      // an empty window ends the kernel loop at the first row fetch
+      instr.SetUpdate(kern_row, 
+                      Ite(is_empty, BvConst(0, kern_bw), Extract(row_win.first, kern_bw-1, 0)));
+      instr.SetUpdate(kern_row_last, 
+                      Ite(is_empty, BvConst(0, kern_bw), Extract(row_win.last, kern_bw-1, 0)));
+      instr.SetUpdate(kern_col, Extract(col_win.first, kern_bw-1, 0));
+      instr.SetUpdate(kern_col_first, Extract(col_win.first, kern_bw-1, 0));
+      instr.SetUpdate(kern_col_last, Extract(col_win.last, kern_bw-1, 0));
+
+      auto next_state = 
+        Ite(is_empty,
+            BvConst(CONV_CHILD_STATE_WEIGHT_ROW_FETCH, ACCEL_CONV_CHILD_STATE_BITWIDTH),
+            BvConst(CONV_CHILD_STATE_WEIGHT_SEND_DP, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+
+      instr.SetUpdate(state, next_state);
+    } else {
+      instr.SetUpdate(kern_row, kern_row_init);
+      instr.SetUpdate(kern_col, kern_col_init);
+
+      auto next_state = BvConst(CONV_CHILD_STATE_WEIGHT_CHECK_BOUND,
+                                ACCEL_CONV_CHILD_STATE_BITWIDTH);
+      
+      instr.SetUpdate(state, next_state);
+    }
   }
 
+  // with analytic kernel bounds every visited position is in bound, thus the
+  // row/col increments go to send_dp directly and stop at the window end.
+  auto next_kern_state = (cfg.conv_analytic_kernel_bounds) ?
+    BvConst(CONV_CHILD_STATE_WEIGHT_SEND_DP, ACCEL_CONV_CHILD_STATE_BITWIDTH) :
+    BvConst(CONV_CHILD_STATE_WEIGHT_CHECK_BOUND, ACCEL_CONV_CHILD_STATE_BITWIDTH);
+
   { // instr ---- incrementing kern_row
     auto instr = child.NewInstr("accel_conv_child_weight_row_id");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_ROW_FETCH));
@@ -328,8 +539,10 @@ void DefineConvWeightFetch(Ila& child) {
     
     // update 10282021: fixed the bound condition, should be last_kern_row - row_stride instead of last_kern_row - 1
     auto row_stride_ext = Concat(BvConst(0, 1), row_stride);
-    auto next_kern_row = Ite(kern_row + row_stride_ext >= last_kern_row_ext, 
-                             kern_row_init, kern_row + row_stride_ext);
+    auto is_kern_row_end = (cfg.conv_analytic_kernel_bounds) ?
+      (kern_row + row_stride_ext > child.state(CONV_CHILD_KERNEL_ROW_LAST)) :
+      (kern_row + row_stride_ext >= last_kern_row_ext);
+    auto next_kern_row = Ite(is_kern_row_end, kern_row_init, kern_row + row_stride_ext);
 
     instr.SetUpdate(kern_row, next_kern_row);
 
@@ -341,17 +554,17 @@ void DefineConvWeightFetch(Ila& child) {
 
     // update the col fetch counter
     // fetch a new col only after this kernel job has been finished.
-    auto req_cntr_next = Ite(kern_row + row_stride_ext >= last_kern_row_ext, req_cntr + 1, req_cntr);
+    auto req_cntr_next = Ite(is_kern_row_end, req_cntr + 1, req_cntr);
     instr.SetUpdate(req_cntr, req_cntr_next);
 
     // update 08232020: after incrementing row id, the next instr should be check_out_of_bound
     // instead of incrementing col num, which has been down in the previous instruction.
     auto next_state = 
-      Ite(kern_row + row_stride_ext >= last_kern_row_ext,
+      Ite(is_kern_row_end,
         Ite(last_act_req,
             BvConst(CONV_CHILD_STATE_ACT_INPUT_COL, ACCEL_CONV_CHILD_STATE_BITWIDTH),
             BvConst(CONV_CHILD_STATE_ACT_FETCH_ACT, ACCEL_CONV_CHILD_STATE_BITWIDTH)),
-        BvConst(CONV_CHILD_STATE_WEIGHT_CHECK_BOUND, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+        next_kern_state);
 
     instr.SetUpdate(state, next_state);
   }
@@ -365,18 +578,23 @@ void DefineConvWeightFetch(Ila& child) {
 
     // 10282021: Same fix on bound condition as above
     auto col_stride_ext = Concat(BvConst(0,1), col_stride);
-    auto next_kern_col = Ite(kern_col + col_stride_ext >= last_kern_col_ext,
-                             kern_col_init, kern_col + col_stride_ext);
+    auto is_kern_col_end = (cfg.conv_analytic_kernel_bounds) ?
+      (kern_col + col_stride_ext > child.state(CONV_CHILD_KERNEL_COL_LAST)) :
+      (kern_col + col_stride_ext >= last_kern_col_ext);
+    // the next kernel row restarts from the first live column
+    auto kern_col_restart = (cfg.conv_analytic_kernel_bounds) ?
+      child.state(CONV_CHILD_KERNEL_COL_FIRST) : kern_col_init;
+    auto next_kern_col = Ite(is_kern_col_end, kern_col_restart, kern_col + col_stride_ext);
     auto next_state =
-      Ite(kern_col + col_stride_ext >= last_kern_col_ext,
+      Ite(is_kern_col_end,
           BvConst(CONV_CHILD_STATE_WEIGHT_ROW_FETCH, ACCEL_CONV_CHILD_STATE_BITWIDTH),
-          BvConst(CONV_CHILD_STATE_WEIGHT_CHECK_BOUND, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+          next_kern_state);
 
     instr.SetUpdate(kern_col, next_kern_col);
     instr.SetUpdate(state, next_state);
   }
 
-  { // instr ---- check out-of-bound condition
+  if (!cfg.conv_analytic_kernel_bounds) { // instr ---- check out-of-bound condition
     auto instr = child.NewInstr("accel_conv_check_out_of_bound");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_CHECK_BOUND));
 
@@ -396,23 +614,15 @@ void DefineConvWeightFetch(Ila& child) {
     instr.SetUpdate(state, next_state);
   }
 
-  { // instr ---- send weights and act to datapath
+  if (!cfg.conv_fused_datapath && !cfg.conv_multi_filter) { 
+    // instr ---- send weights and act to datapath
     auto instr = child.NewInstr("accel_conv_send_dp");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_SEND_DP));
 
-    // TODO: this address should be vector level (128bit) address
-    auto weight_req_addr = WtGetAddr(child, filter_idx, kern_row, kern_col, chan_block);
-    // update 08252020: The weight data is expanded, the address should cut in half;
-    auto spad_addr_base = weight_req_addr * (NIC_MEM_ELEM_BYTEWIDTH/2);
-    // auto spad_addr_base = weight_req_addr * NIC_MEM_ELEM_BYTEWIDTH;
-    auto spad0 = child.state(SCRATCH_PAD_0);
-
-    // update 08252020: The weight data should be expand from 8bit to 16bit when reading
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+    auto weights = ConvDpGetWeights(child, cfg);
+    for (auto i = 0; i < lanes; i++) {
       auto wt_array_element = child.state(GetStateName(CONV_CHILD_WEIGHT_ARRAY, i));
-      auto wt_byte_0 = BvConst(0, SCRATCH_PAD_DATA_BITWIDTH);
-      auto wt_byte_1 = Load(spad0, spad_addr_base + i);
-      instr.SetUpdate(wt_array_element, Concat(wt_byte_1, wt_byte_0));
+      instr.SetUpdate(wt_array_element, weights[i]);
     }
 
     auto next_state = BvConst(CONV_CHILD_STATE_DP_MAC_PSUM,
@@ -422,25 +632,303 @@ void DefineConvWeightFetch(Ila& child) {
   }
 }
 
-void DefineConvDatapath(Ila& child) {
+std::vector<ExprRef> ConvDpGetWeights(const Ila& child, const ModelConfig& cfg) {
+  auto lanes = cfg.conv_lanes;
+  if (cfg.conv_weight_cache) {
+    auto entry = Load(child.state(CONV_CHILD_WEIGHT_CACHE), ConvWeightCacheAddr(child));
+    std::vector<ExprRef> weights;
+    for (auto i = 0; i < lanes; i++) {
+      weights.push_back(ConvDpExpandWeight(Extract(entry, 8*i+7, 8*i), cfg));
+    }
+    return weights;
+  }
+
+  return ConvDpLoadWeights(child, child.state(CONV_CHILD_FILTER_ID), cfg);
+}
+
+std::vector<ExprRef> ConvDpLoadWeights(const Ila& child, const ExprRef& filter_idx,
+                                       const ModelConfig& cfg) {
+  // update 08252020: The weight data should be expand from 8bit to 16bit when reading
+  std::vector<ExprRef> weights;
+  for (const auto& wt_byte : ConvLoadWeightBytes(child, filter_idx, cfg)) {
+    weights.push_back(ConvDpExpandWeight(wt_byte, cfg));
+  }
+  return weights;
+}
+
+std::vector<ExprRef> ConvLoadWeightBytes(const Ila& child, const ExprRef& filter_idx,
+                                         const ModelConfig& cfg) {
+  auto lanes = cfg.conv_lanes;
+  auto kern_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
+  auto kern_col = child.state(CONV_CHILD_KERNEL_COL_ID);
+  auto chan_block = child.state(CONV_CHILD_CHAN_BLOCK_ID);
+  auto spad0 = child.state(SCRATCH_PAD_0);
+  std::vector<ExprRef> wt_bytes;
+
+  if (!cfg.conv_grouped) {
+    // TODO: this address should be vector level (128bit) address
+    auto weight_req_addr = WtGetAddr(child, filter_idx, kern_row, kern_col, chan_block, lanes);
+    // update 08252020: The weight data is expanded, the address should cut in half;
+    auto spad_addr_base = ConvWtSpad0Base(child, cfg.spad_double_buffer) +
+                          weight_req_addr * (NIC_MEM_ELEM_BYTEWIDTH/2);
+    return MemLoadBytes(spad0, spad_addr_base, lanes);
+  }
+
+  // grouped conv: a filter whose group has fewer channels than lanes only
+  // stores the weights of its own channels, they go to the lanes of those
+  // channels and the other lanes are zero
+  auto spad_addr_base = ConvGroupedWtAddr(child, filter_idx, kern_row, kern_col, chan_block,
+                                          lanes, cfg.spad_double_buffer);
+  auto first_lane = ConvFilterFirstLane(child, filter_idx, lanes);
+  auto last_lane = first_lane + ConvFilterLanes(child, lanes);
+  for (auto i = 0; i < lanes; i++) {
+    auto lane = BvConst(i, first_lane.bit_width());
+    auto lane_offset = lane - first_lane;
+    auto lane_offset_ext = Concat(BvConst(0, spad_addr_base.bit_width()-lane_offset.bit_width()),
+                                  lane_offset);
+    wt_bytes.push_back(Ite((lane >= first_lane) & (lane < last_lane),
+                           MemLoadBytes(spad0, spad_addr_base + lane_offset_ext, 1)[0],
+                           BvConst(0, SCRATCH_PAD_DATA_BITWIDTH)));
+  }
+  return wt_bytes;
+}
+
+ExprRef ConvDpExpandWeight(const ExprRef& wt_byte, const ModelConfig& cfg) {
+  // the 8-bit weight is the top byte of the MAC weight operand
+  if (cfg.conv_weight_bits == SCRATCH_PAD_DATA_BITWIDTH) {
+    return wt_byte;
+  }
+  return Concat(wt_byte, BvConst(0, cfg.conv_weight_bits - SCRATCH_PAD_DATA_BITWIDTH));
+}
+
+ExprRef ConvDpMacPsum(const std::vector<ExprRef>& weights, const std::vector<ExprRef>& acts,
+                      const ModelConfig& cfg) {
+  auto dp = GetConvDpFuncs(cfg);
+  auto mac_psum = BvConst(0, cfg.conv_psum_bits);
+
+  for (size_t i = 0; i < acts.size(); i++) {
+    std::vector<ExprRef> conv_mac_in = {mac_psum, weights[i], acts[i]};
+    mac_psum = dp.mac(conv_mac_in);
+  }
+
+  return dp.mac_psum2act(mac_psum);
+}
+
+ExprRef ConvDpSpad1Addr(const Ila& child, const ModelConfig& cfg) {
+  auto act_row = child.state(CONV_CHILD_INPUT_ROW_ID);
+  auto act_col = child.state(CONV_CHILD_INPUT_COL_ID);
+  auto k_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
+  auto k_col = child.state(CONV_CHILD_KERNEL_COL_ID);
+  auto act_filter_id = child.state(CONV_CHILD_FILTER_ID);
+
+  //TODO: this address should be vector level address (128bit)
+  auto out_addr = OutActGetAddr(child, act_row, act_col, k_row, k_col, act_filter_id,
+                                cfg.conv_lanes, cfg.conv_act_bits);
+  return ConvOutSpad1Base(child, cfg.conv_act_spad1) + out_addr * NIC_MEM_ELEM_BYTEWIDTH;
+}
+
+ExprRef ConvDpBiasRelu(const Ila& child, const ExprRef& psum_val, const ExprRef& oact_element,
+                       const ModelConfig& cfg) {
+  auto dp = GetConvDpFuncs(cfg);
+  auto wbk_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
+  auto wbk_col = child.state(CONV_CHILD_KERNEL_COL_ID);
+  auto wbact_chblk = child.state(CONV_CHILD_CHAN_BLOCK_ID);
+
+  auto is_first_psum = (wbk_row==0) & (wbk_col==0) & 
+                       (wbact_chblk == ConvChildFirstChanBlock(child, cfg));
+  auto en_accum = child.state(CONV_ENABLE_ACCUM);
+
+  // oact_out is 32 bit
+  auto oact_out = Ite(is_first_psum & (en_accum == 0),
+                      dp.act_add2psum(psum_val, BvConst(0, cfg.conv_act_bits)), 
+                      dp.act_add2psum(psum_val, oact_element));
+  // ------------------------------------------------------------------
+
+  auto wbact_row = child.state(CONV_CHILD_INPUT_ROW_ID);
+  auto wbact_col = child.state(CONV_CHILD_INPUT_COL_ID);
+
+  auto is_last_psum = WtIsLastPsum(child, wbact_row, wbact_col, wbk_row, wbk_col, wbact_chblk,
+                                   cfg.conv_lanes);
+  if (cfg.conv_grouped) {
+    // the last channel block is the last one of the filter's group
+    auto last_kernel_row = child.state(CONV_KERNEL_ROW_NUM);
+    auto last_kernel_col = child.state(CONV_KERNEL_COL_NUM);
+    auto last_kernel_row_ext = Concat(BvConst(0, wbk_row.bit_width()-last_kernel_row.bit_width()),
+                                      last_kernel_row);
+    auto last_kernel_col_ext = Concat(BvConst(0, wbk_col.bit_width()-last_kernel_col.bit_width()),
+                                      last_kernel_col);
+    is_last_psum = (wbk_row == last_kernel_row_ext - 1) & (wbk_col == last_kernel_col_ext - 1) &
+                   (wbact_chblk == ConvChildLastChanBlock(child, cfg));
+  }
+  auto en_bias = child.state(CONV_ENABLE_BIAS);
+  auto chan_bias = child.state(CONV_CHAN_BIAS);
+
+  oact_out = Ite(is_last_psum & (en_bias != 0), 
+                 dp.add_bias(oact_out, chan_bias), oact_out);
+  
+  auto en_relu = child.state(CONV_ENABLE_RELU);
+
+  oact_out = Ite(is_last_psum & (en_relu != 0), dp.psum_relu(oact_out), oact_out);
+  return dp.psum2act(oact_out);
+}
+
+ConvDpFuncs GetConvDpFuncs(const ModelConfig& cfg) {
+  if ((cfg.conv_weight_bits == WEIGHT_TOTAL_BITWIDTH) &&
+      (cfg.conv_act_bits == ACT_TOTAL_BITWIDTH) &&
+      (cfg.conv_psum_bits == PSUM_TOTAL_BITWIDTH)) {
+    return {ConvMac, ConvMacPsum2Act, ActAdd2Psum, ConvAddBias, Psum2Act, PsumRelu};
+  }
+
+  // one set of functions per profile, shared by all the instructions using it
+  static std::map<std::string, ConvDpFuncs> profile_funcs;
+  auto suffix = "_w" + std::to_string(cfg.conv_weight_bits) +
+                "_a" + std::to_string(cfg.conv_act_bits) +
+                "_p" + std::to_string(cfg.conv_psum_bits);
+  auto pos = profile_funcs.find(suffix);
+  if (pos != profile_funcs.end()) {
+    return pos->second;
+  }
+
+  auto weight = SortRef::BV(cfg.conv_weight_bits);
+  auto act = SortRef::BV(cfg.conv_act_bits);
+  auto psum = SortRef::BV(cfg.conv_psum_bits);
+  auto bias = SortRef::BV(CONV_CHAN_BIAS_BITWIDTH);
+  std::vector<SortRef> mac_in = {psum, weight, act};
+
+  ConvDpFuncs funcs = {
+    FuncRef("ConvMac" + suffix, psum, mac_in),
+    FuncRef("ConvMacPsum2Act" + suffix, act, psum),
+    FuncRef("ActAdd2Psum" + suffix, psum, act, act),
+    FuncRef("ConvAddBias" + suffix, psum, psum, bias),
+    FuncRef("Psum2Act" + suffix, act, psum),
+    FuncRef("PsumRelu" + suffix, psum, psum)
+  };
+  profile_funcs.emplace(suffix, funcs);
+  return funcs;
+}
+
+ExprRef ConvChildFirstChanBlock(const Ila& child, const ModelConfig& cfg) {
+  if (cfg.conv_grouped) {
+    return ConvFilterFirstChanBlock(child, child.state(CONV_CHILD_FILTER_ID), cfg.conv_lanes);
+  }
+  return BvConst(0, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+}
+
+ExprRef ConvChildLastChanBlock(const Ila& child, const ModelConfig& cfg) {
+  if (cfg.conv_grouped) {
+    return ConvChildFirstChanBlock(child, cfg) + ConvFilterChanBlocks(child, cfg.conv_lanes) - 1;
+  }
+  // last_channel_block = frac_ceil(input_channels, channel_block_size);
+  auto last_chan_block = ConvLastChanBlock(child, cfg.conv_lanes);
+  return Concat(BvConst(0, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH-last_chan_block.bit_width()),
+                last_chan_block) - 1;
+}
+
+void DefineConvDatapath(Ila& child, const ModelConfig& cfg) {
+  auto lanes = cfg.conv_lanes;
   auto state = child.state(ACCEL_CONV_CHILD_STATE);
   auto is_child_valid = 
         (child.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
 
+  auto ofilter_idx = child.state(CONV_OFILTER_IDX);
+  auto wbact_idx = URem(ofilter_idx - 1, BvConst(lanes, ofilter_idx.bit_width()));
+
+  if (cfg.conv_multi_filter) {
+    // instr ---- one step of a group of filters (one per lane): the activation
+    // vector is multiplied with the weights of every filter in the group, lane i
+    // of the output vector holds filter (group*lanes + i)
+    auto instr = child.NewInstr("conv_child_multi_filter_dp");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_SEND_DP));
+
+    std::vector<ExprRef> acts;
+    for (auto i = 0; i < lanes; i++) {
+      acts.push_back(child.state(GetStateName(CONV_CHILD_ACT_ARRAY, i)));
+    }
+
+    auto filter_group = child.state(CONV_CHILD_FILTER_ID);
+    auto num_filters = child.state(CONV_OFILTER_IDX);
+    auto num_filters_ext = Concat(BvConst(0, filter_group.bit_width()-num_filters.bit_width()),
+                                  num_filters);
+
+    auto spad1_base_addr = ConvDpSpad1Addr(child, cfg);
+    auto spad1 = child.state(SCRATCH_PAD_1);
+    auto oact_elements = MemLoadActVector(spad1, spad1_base_addr, lanes, cfg.conv_act_bits);
+    std::vector<ExprRef> out_elements;
+
+    for (auto i = 0; i < lanes; i++) {
+      auto filter_idx = filter_group * lanes + i;
+      auto psum_val = ConvDpMacPsum(ConvDpLoadWeights(child, filter_idx, cfg), acts, cfg);
+      auto oact_out_act = ConvDpBiasRelu(child, psum_val, oact_elements[i], cfg);
+
+      // lanes past the last filter of the layer are written with zero
+      auto out_element = child.state(GetStateName(CONV_CHILD_OUT_ARRAY, i));
+      auto out_element_next = Ite(filter_idx < num_filters_ext, oact_out_act,
+                                  BvConst(0, cfg.conv_act_bits));
+      instr.SetUpdate(out_element, out_element_next);
+      out_elements.push_back(out_element_next);
+    }
+    instr.SetUpdate(spad1, MemStoreActVector(spad1, spad1_base_addr, out_elements));
+
+    auto next_state = 
+      BvConst(CONV_CHILD_STATE_WEIGHT_COL_FETCH, ACCEL_CONV_CHILD_STATE_BITWIDTH);
+    instr.SetUpdate(state, next_state);
+    return;
+  }
+
+  if (cfg.conv_fused_datapath) {
+    // instr ---- weight fetching, mac, spad1 psum fetching, bias/relu and writing
+    // back in one step, it replaces send_dp, dp_mac_psum, fetch_act_spad1, 
+    // dp_bias_relu and output
+    auto instr = child.NewInstr("conv_child_fused_dp");
+    instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_WEIGHT_SEND_DP));
+
+    std::vector<ExprRef> acts;
+    for (auto i = 0; i < lanes; i++) {
+      acts.push_back(child.state(GetStateName(CONV_CHILD_ACT_ARRAY, i)));
+    }
+    auto psum_val = ConvDpMacPsum(ConvDpGetWeights(child, cfg), acts, cfg);
+
+    // only the lane being written back is needed from spad1
+    auto spad1_base_addr = ConvDpSpad1Addr(child, cfg);
+    auto spad1 = child.state(SCRATCH_PAD_1);
+    auto wbact_addr = spad1_base_addr +
+      Concat(BvConst(0, spad1_base_addr.bit_width()-wbact_idx.bit_width()), wbact_idx) *
+      (cfg.conv_act_bits/8);
+    // the lane is not word-aligned, it is read byte by byte
+    auto oact_bytes = MemLoadBytes(spad1, wbact_addr, cfg.conv_act_bits/8);
+    auto oact_element = oact_bytes[0];
+    for (auto b = 1; b < cfg.conv_act_bits/8; b++) {
+      oact_element = Concat(oact_bytes[b], oact_element);
+    }
+
+    auto oact_out_act = ConvDpBiasRelu(child, psum_val, oact_element, cfg);
+
+    std::vector<ExprRef> out_elements;
+    for (auto i = 0; i < lanes; i++) {
+      auto out_element = child.state(GetStateName(CONV_CHILD_OUT_ARRAY, i));
+      auto out_element_next = Ite(wbact_idx == i, oact_out_act, out_element);
+      instr.SetUpdate(out_element, out_element_next);
+      out_elements.push_back(out_element_next);
+    }
+    instr.SetUpdate(spad1, MemStoreActVector(spad1, spad1_base_addr, out_elements));
+
+    auto next_state = 
+      BvConst(CONV_CHILD_STATE_WEIGHT_COL_FETCH, ACCEL_CONV_CHILD_STATE_BITWIDTH);
+    instr.SetUpdate(state, next_state);
+    return;
+  }
+
   { // instr ---- calculate the mac_psum
     auto instr = child.NewInstr("conv_child_dp_mac_psum");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_DP_MAC_PSUM));
 
-    auto mac_psum = BvConst(0, PSUM_TOTAL_BITWIDTH);
-
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
-      auto weight = child.state(GetStateName(CONV_CHILD_WEIGHT_ARRAY, i));
-      auto act = child.state(GetStateName(CONV_CHILD_ACT_ARRAY, i));
-      std::vector<ExprRef> conv_mac_in = {mac_psum, weight, act};
-      mac_psum = ConvMac(conv_mac_in);
+    std::vector<ExprRef> weights, acts;
+    for (auto i = 0; i < lanes; i++) {
+      weights.push_back(child.state(GetStateName(CONV_CHILD_WEIGHT_ARRAY, i)));
+      acts.push_back(child.state(GetStateName(CONV_CHILD_ACT_ARRAY, i)));
     }
 
-    auto act_psum = ConvMacPsum2Act(mac_psum);
+    auto act_psum = ConvDpMacPsum(weights, acts, cfg);
     instr.SetUpdate(child.state(CONV_CHILD_ACTIVATION_PSUM), act_psum);  
 
     auto next_state = BvConst(CONV_CHILD_STATE_FETCH_OUT_ACT,
@@ -452,22 +940,13 @@ void DefineConvDatapath(Ila& child) {
     auto instr = child.NewInstr("conv_child_fetch_act_spad1");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_FETCH_OUT_ACT));
 
-    auto act_row = child.state(CONV_CHILD_INPUT_ROW_ID);
-    auto act_col = child.state(CONV_CHILD_INPUT_COL_ID);
-    auto k_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
-    auto k_col = child.state(CONV_CHILD_KERNEL_COL_ID);
-    auto act_filter_id = child.state(CONV_CHILD_FILTER_ID);
-    
-    //TODO: this address should be vector level address (128bit)
-    auto oactfetch_addr = OutActGetAddr(child, act_row, act_col, k_row, k_col, act_filter_id);
-    auto spad1_base_addr = oactfetch_addr * NIC_MEM_ELEM_BYTEWIDTH;
+    auto spad1_base_addr = ConvDpSpad1Addr(child, cfg);
     auto spad1 = child.state(SCRATCH_PAD_1);
+    auto oact_elements = MemLoadActVector(spad1, spad1_base_addr, lanes, cfg.conv_act_bits);
 
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+    for (auto i = 0; i < lanes; i++) {
       auto oact_element = child.state(GetStateName(CONV_CHILD_O_ACT_ARRAY, i));
-      auto oact_byte_0 = Load(spad1, spad1_base_addr + 2*i);
-      auto oact_byte_1 = Load(spad1, spad1_base_addr + 2*i + 1);
-      instr.SetUpdate(oact_element, Concat(oact_byte_1, oact_byte_0));
+      instr.SetUpdate(oact_element, oact_elements[i]);
     }
 
     auto next_state = BvConst(CONV_CHILD_STATE_BIAS_RELU, ACCEL_CONV_CHILD_STATE_BITWIDTH);
@@ -480,43 +959,12 @@ void DefineConvDatapath(Ila& child) {
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_BIAS_RELU));
 
     auto psum_val = child.state(CONV_CHILD_ACTIVATION_PSUM); //16
+    auto oact_element = GetActVectorState(child, CONV_CHILD_O_ACT_ARRAY, wbact_idx, lanes);
 
-    // ------------------------------------------------------------------
-
-    auto wbk_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
-    auto wbk_col = child.state(CONV_CHILD_KERNEL_COL_ID);
-    auto wbact_chblk = child.state(CONV_CHILD_CHAN_BLOCK_ID);
-
-    auto is_first_psum = (wbk_row==0) & (wbk_col==0) & (wbact_chblk==0);
-    auto en_accum = child.state(CONV_ENABLE_ACCUM);
-
-    auto ofilter_idx = child.state(CONV_OFILTER_IDX);
-    auto wbact_idx = URem(ofilter_idx - 1, BvConst(CONV_VECTOR_SIZE, ofilter_idx.bit_width()));
-    auto oact_element = GetActVectorState(child, CONV_CHILD_O_ACT_ARRAY, wbact_idx);
-
-    // oact_out is 32 bit
-    auto oact_out = Ite(is_first_psum & (en_accum == 0),
-                        ActAdd2Psum(psum_val, BvConst(0, ACT_TOTAL_BITWIDTH)), 
-                        ActAdd2Psum(psum_val, oact_element));
-    // ------------------------------------------------------------------
-
-    auto wbact_row = child.state(CONV_CHILD_INPUT_ROW_ID);
-    auto wbact_col = child.state(CONV_CHILD_INPUT_COL_ID);
-
-    auto is_last_psum = WtIsLastPsum(child, wbact_row, wbact_col, wbk_row, wbk_col, wbact_chblk);
-    auto en_bias = child.state(CONV_ENABLE_BIAS);
-    auto chan_bias = child.state(CONV_CHAN_BIAS);
-
-    oact_out = Ite(is_last_psum & (en_bias != 0), 
-                   ConvAddBias(oact_out, chan_bias), oact_out);
-    
-    auto en_relu = child.state(CONV_ENABLE_RELU);
-
-    oact_out = Ite(is_last_psum & (en_relu != 0), PsumRelu(oact_out), oact_out);
-    auto oact_out_act = Psum2Act(oact_out);
+    auto oact_out_act = ConvDpBiasRelu(child, psum_val, oact_element, cfg);
 
     // ------------------------------------------------------------------
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
+    for (auto i = 0; i < lanes; i++) {
       auto out_element = child.state(GetStateName(CONV_CHILD_OUT_ARRAY, i));
       auto out_element_next = Ite(wbact_idx == i, oact_out_act, out_element);
       instr.SetUpdate(out_element, out_element_next);
@@ -530,27 +978,15 @@ void DefineConvDatapath(Ila& child) {
     auto instr = child.NewInstr("conv_child_output");
     instr.SetDecode(is_child_valid & (state == CONV_CHILD_STATE_OUT));
 
-    auto act_row = child.state(CONV_CHILD_INPUT_ROW_ID);
-    auto act_col = child.state(CONV_CHILD_INPUT_COL_ID);
-    auto k_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
-    auto k_col = child.state(CONV_CHILD_KERNEL_COL_ID);
-    auto act_filter_id = child.state(CONV_CHILD_FILTER_ID);
-    
-    //TODO: this address should be vector level address (128bit)
-    auto out_addr = OutActGetAddr(child, act_row, act_col, k_row, k_col, act_filter_id);
-    auto spad1_base_addr = out_addr * NIC_MEM_ELEM_BYTEWIDTH;
+    auto spad1_base_addr = ConvDpSpad1Addr(child, cfg);
     auto spad1 = child.state(SCRATCH_PAD_1);
-    auto spad1_next = spad1;
 
-    for (auto i = 0; i < CONV_VECTOR_SIZE; i++) {
-      auto out_element = child.state(GetStateName(CONV_CHILD_OUT_ARRAY, i));
-      auto out_byte_0 = Extract(out_element, 7, 0);
-      auto out_byte_1 = Extract(out_element, 15, 8);
-      spad1_next = Store(spad1_next, spad1_base_addr + 2*i, out_byte_0);
-      spad1_next = Store(spad1_next, spad1_base_addr + 2*i + 1, out_byte_1);
+    std::vector<ExprRef> out_elements;
+    for (auto i = 0; i < lanes; i++) {
+      out_elements.push_back(child.state(GetStateName(CONV_CHILD_OUT_ARRAY, i)));
     }
 
-    instr.SetUpdate(spad1, spad1_next);
+    instr.SetUpdate(spad1, MemStoreActVector(spad1, spad1_base_addr, out_elements));
 
     // next state should jump back to the innerest loop, which is incrementing kern_col
     auto next_state = 
@@ -0,0 +1,73 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: conv_cmdq_child_instr.cc
+
+// This file contains the conv command queue child, which launches the conv
+// triggers enqueued by ACCEL_CONV_TRIGGER_ENQUEUE in order, each once the conv
+// child is done with the previous layer.
+
+#include <ilang/ilang++.h>
+#include <hlscnn/hlscnn_top.h>
+
+namespace ilang {
+namespace hlscnn {
+
+void DefineAccelConvCmdQueueChild(Ila& m, const ModelConfig& cfg) {
+  auto child = m.NewChild("Accel_Conv_Cmdq_Child");
+  auto cnt = m.state(CONV_CMDQ_CNT);
+  child.SetValid(cnt != 0);
+
+  // the next layer may read what the previous one wrote, wait for both the
+  // conv child and the write-back of its outputs
+  auto is_conv_idle = (m.state(ACCEL_CONV_CHILD_VALID_FLAG) != ACCEL_CONV_CHILD_VALID);
+  if (cfg.spad_write_back) {
+    is_conv_idle = is_conv_idle & (m.state(SPAD_WB_CHILD_VALID_FLAG) == 0);
+  }
+
+  { // instr ---- dequeue the head trigger and launch its layer
+    auto instr = child.NewInstr("accel_conv_cmdq_launch");
+    instr.SetDecode((cnt != 0) & is_conv_idle);
+
+    auto head = m.state(GetStateName(CONV_CMDQ_ENTRY, 0));
+    SetConvTriggerUpdate(instr, m, cfg,
+                         Extract(head, 31, 0),    // act base
+                         Extract(head, 63, 32),   // weight base
+                         Extract(head, 95, 64),   // output base
+                         Extract(head, 127, 96),  // input size
+                         Extract(head, 159, 128), // output size
+                         Extract(head, 191, 160), // kernel size
+                         Extract(head, 223, 192)); // channel
+
+    // shift the queue, the stale last entry is no longer counted
+    for (auto i = 0; i < cfg.conv_cmd_queue_depth - 1; i++) {
+      instr.SetUpdate(m.state(GetStateName(CONV_CMDQ_ENTRY, i)),
+                      m.state(GetStateName(CONV_CMDQ_ENTRY, i + 1)));
+    }
+    instr.SetUpdate(cnt, cnt - 1);
+  }
+}
+
+} // namespace hlscnn
+} // namespace ilang
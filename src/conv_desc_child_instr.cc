@@ -0,0 +1,135 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+
+// File: conv_desc_child_instr.cc
+
+// This file contains the conv descriptor child, which walks a chain of conv
+// layer descriptors in the virtual soc memory. Once the conv child is done
+// with the previous layer, it starts the SPAD child on the weights of the
+// descriptor, waits for it, and launches the layer as ACCEL_CONV_TRIGGER does.
+
+#include <ilang/ilang++.h>
+#include <hlscnn/hlscnn_top.h>
+
+namespace ilang {
+namespace hlscnn {
+
+void DefineAccelConvDescChild(Ila& m, const ModelConfig& cfg) {
+  auto child = m.NewChild("Accel_Conv_Desc_Child");
+  auto valid_flag = m.state(CONV_DESC_CHILD_VALID_FLAG);
+  child.SetValid(valid_flag == 1);
+
+  auto desc_addr = m.state(CONV_DESC_ADDR);
+  auto desc_state = m.state(CONV_DESC_STATE);
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+
+  // the next layer may read what the previous one wrote, wait for both the
+  // conv child and the write-back of its outputs
+  auto is_conv_idle = (m.state(ACCEL_CONV_CHILD_VALID_FLAG) != ACCEL_CONV_CHILD_VALID);
+  if (cfg.spad_write_back) {
+    is_conv_idle = is_conv_idle & (m.state(SPAD_WB_CHILD_VALID_FLAG) == 0);
+  }
+  auto spad_valid_flag = m.state(SPAD_CHILD_VALID_FLAG);
+  auto is_spad_idle = (spad_valid_flag == 0);
+
+  { // instr ---- start the SPAD child on the weights of the layer
+    auto instr = child.NewInstr("accel_conv_desc_wt_dma");
+    // the running layer still reads the weights in spad0; with ping-pong halves
+    // (ModelConfig::spad_double_buffer) the next weights go to the other half,
+    // and a SPAD beat into the half of the running layer waits for it anyway
+    auto is_decode = (valid_flag == 1) & (desc_state == CONV_DESC_STATE_WT_DMA) & is_spad_idle;
+    if (!cfg.spad_double_buffer) {
+      is_decode = is_decode & is_conv_idle;
+    }
+    instr.SetDecode(is_decode);
+
+    auto desc_wt = MemLoadWord(vir_mem, desc_addr + 2*NIC_MEM_ELEM_BYTEWIDTH);
+    auto wt_soc_addr = Extract(desc_wt, 31, 0);
+    auto wt_length = Extract(desc_wt, 63, 32);
+    // the SPAD child would never finish an empty transfer
+    auto is_wt_dma = (wt_length != 0);
+
+    // the SPAD child reads the soc memory range from the config registers
+    auto soc_mem_base = m.state(CFG_REG_SOC_MEM_BASE_ADDR);
+    auto soc_mem_length = m.state(CFG_REG_SOC_MEM_RD_WR_LENGTH);
+    instr.SetUpdate(soc_mem_base, Ite(is_wt_dma, wt_soc_addr, soc_mem_base));
+    instr.SetUpdate(soc_mem_length, Ite(is_wt_dma, wt_length, soc_mem_length));
+
+    instr.SetUpdate(spad_valid_flag,
+                    Ite(is_wt_dma, BvConst(1, SPAD_CHILD_VALID_FLAG_BITWIDTH), spad_valid_flag));
+    instr.SetUpdate(m.state(SPAD_RD_WR_CNTR), BvConst(0, SPAD_RD_WR_CNTR_BITWIDTH));
+    instr.SetUpdate(m.state(SPAD_CHILD_TARGET), BvConst(0, SPAD_CHILD_TARGET_BITWIDTH));
+    if (cfg.axi_master_outstanding > 0) {
+      instr.SetUpdate(m.state(SPAD_RD_REQ_CNTR), BvConst(0, SPAD_RD_REQ_CNTR_BITWIDTH));
+    }
+    // the weights go where the conv children read them (see ConvWtSpad0Base)
+    auto wt_spad_addr = (cfg.spad_double_buffer) ?
+      Extract(MemLoadWord(vir_mem, desc_addr), 63, 32) :
+      BvConst(0, SPAD_CHILD_SPAD_ADDR_BITWIDTH);
+    instr.SetUpdate(m.state(SPAD_CHILD_SPAD_ADDR), wt_spad_addr);
+
+    instr.SetUpdate(desc_state, BvConst(CONV_DESC_STATE_LAUNCH, CONV_DESC_STATE_BITWIDTH));
+  }
+
+  { // instr ---- fetch the descriptor and launch its layer
+    auto instr = child.NewInstr("accel_conv_desc_launch");
+    instr.SetDecode((valid_flag == 1) & (desc_state == CONV_DESC_STATE_LAUNCH) &
+                    is_conv_idle & is_spad_idle);
+
+    auto desc_lo = MemLoadWord(vir_mem, desc_addr);
+    auto desc_hi = MemLoadWord(vir_mem, desc_addr + NIC_MEM_ELEM_BYTEWIDTH);
+
+    auto act_base_addr = Extract(desc_lo, 31, 0);
+    auto weight_base_addr = Extract(desc_lo, 63, 32);
+    auto output_base_addr = Extract(desc_lo, 95, 64);
+    auto input_size_config = Extract(desc_lo, 127, 96);
+    auto output_size_config = Extract(desc_hi, 31, 0);
+    auto kernel_size_config = Extract(desc_hi, 63, 32);
+    auto channel_config = Extract(desc_hi, 95, 64);
+    auto next_desc_addr = Extract(desc_hi, 127, 96);
+
+    // the config registers read back as if the host had written the layer
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_CONV_ACT_BASE_ADDR), act_base_addr);
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR), weight_base_addr);
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR), output_base_addr);
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG), input_size_config);
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG), output_size_config);
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_KERNEL_SIZE_CFG), kernel_size_config);
+    instr.SetUpdate(m.state(CFG_REG_ACCEL_CONV_CHANNEL_CFG), channel_config);
+
+    SetConvTriggerUpdate(instr, m, cfg, act_base_addr, weight_base_addr, output_base_addr,
+                         input_size_config, output_size_config, kernel_size_config,
+                         channel_config);
+
+    instr.SetUpdate(desc_addr, next_desc_addr);
+    instr.SetUpdate(desc_state, BvConst(CONV_DESC_STATE_WT_DMA, CONV_DESC_STATE_BITWIDTH));
+    instr.SetUpdate(valid_flag, Ite(next_desc_addr == 0,
+                                    BvConst(0, CONV_DESC_CHILD_VALID_FLAG_BITWIDTH),
+                                    BvConst(1, CONV_DESC_CHILD_VALID_FLAG_BITWIDTH)));
+  }
+}
+
+} // namespace hlscnn
+} // namespace ilang
@@ -26,11 +26,118 @@
 
 #include <ilang/ilang++.h>
 #include <hlscnn/hlscnn_top.h>
+#include <vector>
 
 namespace ilang {
 namespace hlscnn {
 
-void DefineAccelConvTrigger(Ila& m) {
+// latch the conv params of a layer and start it, shared by ACCEL_CONV_TRIGGER
+// and the conv descriptor child
+void SetConvTriggerUpdate(InstrRef& instr, Ila& m, const ModelConfig& cfg,
+                          const ExprRef& act_base_addr,
+                          const ExprRef& weight_base_addr,
+                          const ExprRef& output_base_addr,
+                          const ExprRef& input_size_config,
+                          const ExprRef& output_size_config,
+                          const ExprRef& kernel_size_config,
+                          const ExprRef& channel_config) {
+  instr.SetUpdate(m.state(CONV_ACT_BASE), act_base_addr);
+  instr.SetUpdate(m.state(CONV_WEIGHT_BASE), weight_base_addr);
+  instr.SetUpdate(m.state(CONV_SPAD_OUTPUT_BASE), output_base_addr);
+  
+  instr.SetUpdate(m.state(CONV_INPUT_COL_NUM), Extract(input_size_config, 9, 0));
+  instr.SetUpdate(m.state(CONV_INPUT_ROW_NUM), Extract(input_size_config, 19, 10));
+  instr.SetUpdate(m.state(CONV_INPUT_CHAN_NUM), Extract(input_size_config, 31, 20));
+
+  instr.SetUpdate(m.state(CONV_OUTPUT_COL_NUM), Extract(output_size_config, 9, 0));
+  instr.SetUpdate(m.state(CONV_OUTPUT_ROW_NUM), Extract(output_size_config, 19, 10));
+  instr.SetUpdate(m.state(CONV_OUTPUT_CHAN_NUM), Extract(output_size_config, 31, 20));
+
+  instr.SetUpdate(m.state(CONV_KERNEL_COL_NUM), Extract(kernel_size_config, 7, 0));
+  instr.SetUpdate(m.state(CONV_KERNEL_ROW_NUM), Extract(kernel_size_config, 15, 8));
+  instr.SetUpdate(m.state(CONV_KERNEL_C_STRIDE), Extract(kernel_size_config, 18, 16));
+  instr.SetUpdate(m.state(CONV_KERNEL_R_STRIDE), Extract(kernel_size_config, 21, 19));
+
+  if (cfg.conv_fused_pool) {
+    instr.SetUpdate(m.state(CONV_POOL_SIZE), Extract(kernel_size_config, 23, 22));
+    instr.SetUpdate(m.state(CONV_POOL_AVG), SelectBit(kernel_size_config, 24));
+  }
+  if (cfg.conv_act_spad1) {
+    instr.SetUpdate(m.state(CONV_ACT_SRC_SPAD1), SelectBit(kernel_size_config, 25));
+  }
+
+  if (cfg.spad_double_buffer) {
+    // the conv child owns the spad0 half of its weights and the spad1 half of
+    // its outputs (and of its activations when read from spad1) until it is done
+    auto spad1_out_base = (cfg.conv_act_spad1) ?
+      output_base_addr : BvConst(0, output_base_addr.bit_width());
+    auto half_0 = BvConst(0, SPAD_CONV_HALF_BITWIDTH);
+    auto half_1 = BvConst(1, SPAD_CONV_HALF_BITWIDTH);
+    instr.SetUpdate(m.state(SPAD0_CONV_HALF),
+                    Ite(weight_base_addr >= SPAD_HALF_BYTE_NUM, half_1, half_0));
+    instr.SetUpdate(m.state(SPAD1_CONV_HALF),
+                    Ite(spad1_out_base >= SPAD_HALF_BYTE_NUM, half_1, half_0));
+    if (cfg.conv_act_spad1) {
+      instr.SetUpdate(m.state(SPAD1_CONV_ACT_HALF),
+                      Ite(act_base_addr >= SPAD_HALF_BYTE_NUM, half_1, half_0));
+    }
+  }
+
+  instr.SetUpdate(m.state(CONV_CHAN_BIAS), Extract(channel_config, 15, 0));
+  
+  instr.SetUpdate(m.state(CONV_ENABLE_BIAS), SelectBit(channel_config, 16));
+  instr.SetUpdate(m.state(CONV_ENABLE_RELU), SelectBit(channel_config, 17));
+  instr.SetUpdate(m.state(CONV_ENABLE_ACCUM), SelectBit(channel_config, 18));
+
+  instr.SetUpdate(m.state(CONV_OFILTER_IDX), Extract(channel_config, 26, 19));
+
+  instr.SetUpdate(m.state(CONV_ENABLE_WB), SelectBit(channel_config, 27));
+
+  if (cfg.conv_grouped) {
+    instr.SetUpdate(m.state(CONV_GROUP_NUM_LOG2), Extract(channel_config, 31, 28));
+  }
+
+  auto child_valid_flag = m.state(ACCEL_CONV_CHILD_VALID_FLAG);
+
+  if (cfg.conv_layer_uf) {
+    // compute the whole layer here, the conv child is never started
+    auto r_stride = Extract(kernel_size_config, 21, 19);
+    auto c_stride = Extract(kernel_size_config, 18, 16);
+    auto r_stride_ext = Concat(BvConst(0, CONV_KERNEL_R_STRIDE_BITWIDTH-r_stride.bit_width()),
+                               r_stride);
+    auto c_stride_ext = Concat(BvConst(0, CONV_KERNEL_C_STRIDE_BITWIDTH-c_stride.bit_width()),
+                               c_stride);
+    std::vector<ExprRef> conv_layer_in = {
+      m.state(VIRTUAL_SOC_MEMORY), m.state(SCRATCH_PAD_0), m.state(SCRATCH_PAD_1),
+      act_base_addr,
+      Extract(input_size_config, 19, 10), Extract(input_size_config, 9, 0),
+      Extract(input_size_config, 31, 20),
+      Extract(kernel_size_config, 15, 8), Extract(kernel_size_config, 7, 0),
+      r_stride_ext, c_stride_ext,
+      Extract(channel_config, 15, 0),
+      SelectBit(channel_config, 16), SelectBit(channel_config, 17),
+      SelectBit(channel_config, 18), Extract(channel_config, 26, 19)
+    };
+    instr.SetUpdate(m.state(SCRATCH_PAD_1), ConvLayer(conv_layer_in));
+
+    if (cfg.spad_write_back) {
+      // ENABLE_WB: write the outputs back to the soc memory
+      SetSPADWriteBackStart(instr, m, SelectBit(channel_config, 27) == 1,
+                            BvConst(0, SPAD_WB_SPAD_ADDR_BITWIDTH));
+    }
+
+    instr.SetUpdate(child_valid_flag,
+                    BvConst(ACCEL_CONV_CHILD_INVALID, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH));
+  } else {
+    // set the child valid flag
+    instr.SetUpdate(child_valid_flag,
+                    BvConst(ACCEL_CONV_CHILD_VALID, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH));
+  }
+  instr.SetUpdate(m.state(ACCEL_CONV_CHILD_STATE),
+                  BvConst(CONV_CHILD_STATE_IDLE, ACCEL_CONV_CHILD_STATE_BITWIDTH));
+}
+
+void DefineAccelConvTrigger(Ila& m, const ModelConfig& cfg) {
   // define config write instructions
   auto is_write = (m.input(TOP_SLAVE_IF_WR) & ~m.input(TOP_SLAVE_IF_RD));
   // masked address.
@@ -38,7 +145,7 @@ void DefineAccelConvTrigger(Ila& m) {
   // offset from the CPU.""
   auto masked_addr = Concat(BvConst(0, 8), 
                             Extract(m.input(TOP_SLAVE_ADDR_IN), 23, 0));
-  auto is_config_addr = (masked_addr < SPAD0_BASE_ADDR);
+  auto is_config_addr = CfgRegIsConfigAddr(masked_addr, cfg.cfg_wide_write);
 
   // get the aligned data. Reg data is only 32 bit
 
@@ -58,49 +165,64 @@ void DefineAccelConvTrigger(Ila& m) {
   { // instr: AccelConvTrigger
     auto instr = m.NewInstr("ACCEL_CONV_TRIGGER");
 
-    instr.SetDecode(is_write & is_config_addr & (reg_id == AccelConvTrigger));
-
-    auto input_size_config = m.state(CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG);
-    auto output_size_config = m.state(CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG);
-    auto kernel_size_config = m.state(CFG_REG_ACCEL_KERNEL_SIZE_CFG);
-    auto channel_config = m.state(CFG_REG_ACCEL_CONV_CHANNEL_CFG);
-    
-    instr.SetUpdate(m.state(CONV_ACT_BASE), m.state(CFG_REG_ACCEL_CONV_ACT_BASE_ADDR));
-    instr.SetUpdate(m.state(CONV_WEIGHT_BASE), m.state(CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR));
-    instr.SetUpdate(m.state(CONV_SPAD_OUTPUT_BASE), m.state(CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR));
-    
-    instr.SetUpdate(m.state(CONV_INPUT_COL_NUM), Extract(input_size_config, 9, 0));
-    instr.SetUpdate(m.state(CONV_INPUT_ROW_NUM), Extract(input_size_config, 19, 10));
-    instr.SetUpdate(m.state(CONV_INPUT_CHAN_NUM), Extract(input_size_config, 31, 20));
+    auto is_trigger = is_write & is_config_addr & (reg_id == AccelConvTrigger);
+    if (cfg.conv_cmd_queue_depth > 0) {
+      // start the layer right away only when nothing is in flight
+      auto is_conv_busy = (m.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
+      is_trigger = is_trigger & ~is_conv_busy & (m.state(CONV_CMDQ_CNT) == 0);
+    }
+    instr.SetDecode(is_trigger);
+
+    SetConvTriggerUpdate(instr, m, cfg,
+                         m.state(CFG_REG_ACCEL_CONV_ACT_BASE_ADDR),
+                         m.state(CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR),
+                         m.state(CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR),
+                         m.state(CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG),
+                         m.state(CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG),
+                         m.state(CFG_REG_ACCEL_KERNEL_SIZE_CFG),
+                         m.state(CFG_REG_ACCEL_CONV_CHANNEL_CFG));
 
-    instr.SetUpdate(m.state(CONV_OUTPUT_COL_NUM), Extract(output_size_config, 9, 0));
-    instr.SetUpdate(m.state(CONV_OUTPUT_ROW_NUM), Extract(output_size_config, 19, 10));
-    instr.SetUpdate(m.state(CONV_OUTPUT_CHAN_NUM), Extract(output_size_config, 31, 20));
-
-    instr.SetUpdate(m.state(CONV_KERNEL_COL_NUM), Extract(kernel_size_config, 7, 0));
-    instr.SetUpdate(m.state(CONV_KERNEL_ROW_NUM), Extract(kernel_size_config, 15, 8));
-    instr.SetUpdate(m.state(CONV_KERNEL_C_STRIDE), Extract(kernel_size_config, 18, 16));
-    instr.SetUpdate(m.state(CONV_KERNEL_R_STRIDE), Extract(kernel_size_config, 21, 19));
+    // the declaration of child is moved to top.
+    // DefineAccelConvChild(m);
+  }
 
-    instr.SetUpdate(m.state(CONV_CHAN_BIAS), Extract(channel_config, 15, 0));
-    
-    instr.SetUpdate(m.state(CONV_ENABLE_BIAS), SelectBit(channel_config, 16));
-    instr.SetUpdate(m.state(CONV_ENABLE_RELU), SelectBit(channel_config, 17));
-    instr.SetUpdate(m.state(CONV_ENABLE_ACCUM), SelectBit(channel_config, 18));
+  if (cfg.conv_cmd_queue_depth > 0) { // instr: enqueue a conv trigger
+    auto instr = m.NewInstr("ACCEL_CONV_TRIGGER_ENQUEUE");
+
+    auto cnt = m.state(CONV_CMDQ_CNT);
+    auto is_conv_busy = (m.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
+    instr.SetDecode(is_write & is_config_addr & (reg_id == AccelConvTrigger) &
+                    (is_conv_busy | (cnt != 0)) & (cnt < cfg.conv_cmd_queue_depth));
+
+    // the layer is latched now, the host may write the next one meanwhile
+    auto entry_in = Concat(m.state(CFG_REG_ACCEL_CONV_CHANNEL_CFG),
+                           m.state(CFG_REG_ACCEL_KERNEL_SIZE_CFG));
+    entry_in = Concat(entry_in, m.state(CFG_REG_ACCEL_CONV_OUTPUT_SIZE_CFG));
+    entry_in = Concat(entry_in, m.state(CFG_REG_ACCEL_CONV_INPUT_SIZE_CFG));
+    entry_in = Concat(entry_in, m.state(CFG_REG_ACCEL_CONV_OUTPUT_BASE_ADDR));
+    entry_in = Concat(entry_in, m.state(CFG_REG_ACCEL_CONV_WEIGHT_BASE_ADDR));
+    entry_in = Concat(entry_in, m.state(CFG_REG_ACCEL_CONV_ACT_BASE_ADDR));
+
+    for (auto i = 0; i < cfg.conv_cmd_queue_depth; i++) {
+      auto entry = m.state(GetStateName(CONV_CMDQ_ENTRY, i));
+      instr.SetUpdate(entry, Ite(cnt == i, entry_in, entry));
+    }
+    instr.SetUpdate(cnt, cnt + 1);
+  }
 
-    instr.SetUpdate(m.state(CONV_OFILTER_IDX), Extract(channel_config, 26, 19));
+  if (cfg.conv_desc_chain) { // instr: write the addr of the first layer descriptor
+    auto instr = m.NewInstr("CFG_REG_WR_ACCEL_CONV_DESC_ADDR");
 
-    instr.SetUpdate(m.state(CONV_ENABLE_WB), SelectBit(channel_config, 27));
+    instr.SetDecode(is_write & is_config_addr & (reg_id == AccelConvDescAddr));
 
-    // set the child valid flag
-    auto child_valid_flag = m.state(ACCEL_CONV_CHILD_VALID_FLAG);
-    instr.SetUpdate(child_valid_flag, 
-                    BvConst(ACCEL_CONV_CHILD_VALID, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH));
-    instr.SetUpdate(m.state(ACCEL_CONV_CHILD_STATE),
-                    BvConst(CONV_CHILD_STATE_IDLE, ACCEL_CONV_CHILD_STATE_BITWIDTH));
-    
-    // the declaration of child is moved to top.
-    // DefineAccelConvChild(m);
+    // a zero addr is the end of the chain
+    auto desc_addr = GetCfgRegAlignedData(m);
+    instr.SetUpdate(m.state(CONV_DESC_ADDR), desc_addr);
+    instr.SetUpdate(m.state(CONV_DESC_STATE),
+                    BvConst(CONV_DESC_STATE_WT_DMA, CONV_DESC_STATE_BITWIDTH));
+    instr.SetUpdate(m.state(CONV_DESC_CHILD_VALID_FLAG),
+                    Ite(desc_addr == 0, BvConst(0, CONV_DESC_CHILD_VALID_FLAG_BITWIDTH),
+                                        BvConst(1, CONV_DESC_CHILD_VALID_FLAG_BITWIDTH)));
   }
 }
 
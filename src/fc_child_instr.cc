@@ -0,0 +1,176 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: fc_child_instr.cc
+
+// This file contains the fully-connected child started by AccelStartFlagReg.
+// The weights (8 bit, row-major num_rows x num_cols) are streamed from the
+// virtual soc memory at fc_weight_base, and each weight vector is read once and
+// reused by all the FC_BATCH_SIZE+1 activation vectors of the batch. The
+// activations (batch x num_cols, 16 bit) are read from spad0 at fc_act_base,
+// the outputs (batch x num_rows, 16 bit) are written to spad1 at fc_act_base.
+
+#include <ilang/ilang++.h>
+#include <hlscnn/hlscnn_top.h>
+#include <vector>
+
+namespace ilang {
+namespace hlscnn {
+
+// the FC rows/cols are not multiples of the vector size, thus a single output
+// is written into the middle of a word of a word-level spad1
+static ExprRef FCStoreAct(const ExprRef& spad, const ExprRef& addr, const ExprRef& act,
+                          const ExprRef& is_written) {
+  if (!MemIsWordLevel(spad)) {
+    auto out_byte_0 = Ite(is_written, Extract(act, 7, 0), Load(spad, addr));
+    auto out_byte_1 = Ite(is_written, Extract(act, 15, 8), Load(spad, addr + 1));
+    auto spad_next = Store(spad, addr, out_byte_0);
+    return Store(spad_next, addr + 1, out_byte_1);
+  }
+  auto word = MemLoadWord(spad, addr);
+  auto word_bitwidth = word.bit_width();
+  auto shift = Concat(BvConst(0, word_bitwidth - 4), Extract(addr, 3, 0)) * 8;
+  auto mask = Concat(BvConst(0, word_bitwidth - ACT_TOTAL_BITWIDTH),
+                     BvConst(0xffff, ACT_TOTAL_BITWIDTH)) << shift;
+  auto act_ext = Concat(BvConst(0, word_bitwidth - ACT_TOTAL_BITWIDTH), act) << shift;
+  return MemStoreWord(spad, addr, Ite(is_written, (word & ~mask) | act_ext, word));
+}
+
+void DefineAccelFCChild(Ila& m) {
+  auto child = m.NewChild("Accel_FC_Child");
+  auto child_valid_flag = m.state(ACCEL_FC_CHILD_VALID_FLAG);
+  child.SetValid(child_valid_flag == ACCEL_FC_CHILD_VALID);
+
+  // Declare child states
+  child.NewBvState(FC_CHILD_ROW_ID, FC_CHILD_ROW_ID_BITWIDTH);
+  child.NewBvState(FC_CHILD_COL_BLOCK_ID, FC_CHILD_COL_BLOCK_ID_BITWIDTH);
+  for (auto b = 0; b < FC_MAC_BATCH; b++) {
+    child.NewBvState(GetStateName(FC_CHILD_PSUM_ARRAY, b), FC_CHILD_PSUM_ARRAY_BITWIDTH);
+  }
+
+  auto state = child.state(ACCEL_FC_CHILD_STATE);
+  auto is_child_valid = (child.state(ACCEL_FC_CHILD_VALID_FLAG) == ACCEL_FC_CHILD_VALID);
+
+  auto row = child.state(FC_CHILD_ROW_ID);
+  auto col_block = child.state(FC_CHILD_COL_BLOCK_ID);
+
+  { // instr ---- start the FC loops
+    auto instr = child.NewInstr("accel_fc_start");
+    instr.SetDecode(is_child_valid & (state == FC_CHILD_STATE_IDLE));
+
+    instr.SetUpdate(row, BvConst(0, FC_CHILD_ROW_ID_BITWIDTH));
+    instr.SetUpdate(col_block, BvConst(0, FC_CHILD_COL_BLOCK_ID_BITWIDTH));
+    // a layer without rows has nothing to compute or write
+    instr.SetUpdate(state, Ite(child.state(FC_NUM_ROWS) == 0,
+                               BvConst(FC_CHILD_STATE_DONE, ACCEL_FC_CHILD_STATE_BITWIDTH),
+                               BvConst(FC_CHILD_STATE_MAC, ACCEL_FC_CHILD_STATE_BITWIDTH)));
+  }
+
+  { // instr ---- FC done
+    auto instr = child.NewInstr("accel_fc_done");
+    instr.SetDecode(is_child_valid & (state == FC_CHILD_STATE_DONE));
+
+    instr.SetUpdate(state, BvConst(FC_CHILD_STATE_IDLE, ACCEL_FC_CHILD_STATE_BITWIDTH));
+    instr.SetUpdate(child.state(ACCEL_FC_CHILD_VALID_FLAG),
+      BvConst(ACCEL_FC_CHILD_INVALID, ACCEL_FC_CHILD_VALID_FLAG_BITWIDTH));
+  }
+
+  { // instr ---- MAC one weight vector of the row with the whole batch
+    auto instr = child.NewInstr("accel_fc_mac");
+    instr.SetDecode(is_child_valid & (state == FC_CHILD_STATE_MAC));
+
+    auto addr_bitwidth = FC_ADDR_WIDTH;
+    auto num_rows = Concat(BvConst(0, addr_bitwidth-FC_NUM_ROWS_BITWIDTH),
+                           child.state(FC_NUM_ROWS));
+    auto num_cols = Concat(BvConst(0, addr_bitwidth-FC_NUM_COLS_BITWIDTH),
+                           child.state(FC_NUM_COLS));
+    auto batch_size = child.state(FC_BATCH_SIZE);
+    auto row_ext = Concat(BvConst(0, addr_bitwidth-row.bit_width()), row);
+    auto col_base = Concat(BvConst(0, addr_bitwidth-col_block.bit_width()), col_block) *
+                    FC_MAC_VECTOR_SIZE;
+
+    // the weight vector is fetched once per step and expanded from 8bit to
+    // 16bit as the conv weights. Columns past num_cols are read as zero
+    // weights, which leave the MAC sums unchanged.
+    auto vir_mem = child.state(VIRTUAL_SOC_MEMORY);
+    auto wt_addr = child.state(FC_WEIGHT_BASE) + row_ext * num_cols + col_base;
+    std::vector<ExprRef> weights;
+    for (auto i = 0; i < FC_MAC_VECTOR_SIZE; i++) {
+      auto wt = Concat(MemLoadBytes(vir_mem, wt_addr + i, 1)[0],
+                       BvConst(0, VIRTUAL_SOC_MEMORY_DATA_BITWIDTH));
+      weights.push_back(Ite(col_base + i < num_cols, wt, BvConst(0, WEIGHT_TOTAL_BITWIDTH)));
+    }
+
+    auto is_last_col_blk = (col_base + FC_MAC_VECTOR_SIZE >= num_cols);
+    auto is_last_row = is_last_col_blk & (row_ext + 1 >= num_rows);
+
+    auto act_func = child.state(FC_ACT_FUNC);
+    auto relu_threshold = child.state(FC_RELU_THRESHOLD);
+
+    auto spad0 = child.state(SCRATCH_PAD_0);
+    auto spad1 = child.state(SCRATCH_PAD_1);
+    auto spad1_next = spad1;
+
+    for (auto b = 0; b < FC_MAC_BATCH; b++) {
+      auto psum = child.state(GetStateName(FC_CHILD_PSUM_ARRAY, b));
+      auto is_in_batch = (batch_size >= b);
+
+      auto act_addr = child.state(FC_ACT_BASE) + (num_cols * b + col_base) * (ACT_TOTAL_BITWIDTH/8);
+      auto mac_psum = Ite(col_block == 0, BvConst(0, PSUM_TOTAL_BITWIDTH), psum);
+      for (auto i = 0; i < FC_MAC_VECTOR_SIZE; i++) {
+        auto act_bytes = MemLoadBytes(spad0, act_addr + 2*i, 2);
+        auto act = Concat(act_bytes[1], act_bytes[0]);
+        std::vector<ExprRef> fc_mac_in = {mac_psum, weights[i], act};
+        mac_psum = ConvMac(fc_mac_in);
+      }
+      instr.SetUpdate(psum, Ite(is_in_batch, mac_psum, psum));
+
+      // the output of the row is written after its last weight vector
+      // act func encodings: 0 none, 1 ReLU, 2 ReLU threshold
+      auto out_psum = ActAdd2Psum(ConvMacPsum2Act(mac_psum), BvConst(0, ACT_TOTAL_BITWIDTH));
+      out_psum = Ite(act_func == 1, PsumRelu(out_psum),
+                     Ite(act_func == 2, PsumReluThreshold(out_psum, relu_threshold), out_psum));
+      auto out_act = Psum2Act(out_psum);
+
+      auto is_written = is_in_batch & is_last_col_blk;
+      auto out_addr = child.state(FC_ACT_BASE) + (num_rows * b + row_ext) * (ACT_TOTAL_BITWIDTH/8);
+      spad1_next = FCStoreAct(spad1_next, out_addr, out_act, is_written);
+    }
+    instr.SetUpdate(spad1, spad1_next);
+
+    auto next_col_block = Ite(is_last_col_blk, BvConst(0, col_block.bit_width()), col_block + 1);
+    auto next_row = Ite(is_last_row, BvConst(0, row.bit_width()),
+                        Ite(is_last_col_blk, row + 1, row));
+    auto next_state = Ite(is_last_row,
+                          BvConst(FC_CHILD_STATE_DONE, ACCEL_FC_CHILD_STATE_BITWIDTH),
+                          BvConst(FC_CHILD_STATE_MAC, ACCEL_FC_CHILD_STATE_BITWIDTH));
+
+    instr.SetUpdate(col_block, next_col_block);
+    instr.SetUpdate(row, next_row);
+    instr.SetUpdate(state, next_state);
+  }
+}
+
+} // namespace hlscnn
+} // namespace ilang
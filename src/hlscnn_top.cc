@@ -32,23 +32,23 @@
 namespace ilang {
 namespace hlscnn {
 
-Ila GetHlscnnIla(const std::string& model_name) {
+Ila GetHlscnnIla(const std::string& model_name, const ModelConfig& cfg) {
   auto m = Ila(model_name);
 
   SetUnsignedComparison(true);
   // model valid function
 
   // Define top input
-  DefineTopIO(m);
+  DefineTopIO(m, cfg);
   // Define configuration states
   DefineConfigReg(m);
   DefineFCParam(m);
-  DefineConvParam(m);
-  DefineReduceParam(m);
+  DefineConvParam(m, cfg);
+  DefineReduceParam(m, cfg);
 
   // Define Arch states
-  DefineArchState(m);
-  DefineInternalState(m);
+  DefineArchState(m, cfg);
+  DefineInternalState(m, cfg);
 
   // Define Init Conditions
   DefineInitCond(m);
@@ -59,16 +59,124 @@ Ila GetHlscnnIla(const std::string& model_name) {
   m.SetValid(valid_req & valid_addr);
 
 
+  ILA_ASSERT((cfg.conv_weight_bits >= SCRATCH_PAD_DATA_BITWIDTH) &&
+             ((cfg.conv_act_bits == 8) || (cfg.conv_act_bits == 16)) &&
+             (cfg.conv_psum_bits > 0))
+    << "conv_weight_bits must be at least " << SCRATCH_PAD_DATA_BITWIDTH
+    << ", conv_act_bits 8 or 16";
+  // the vector address generators assume whole 16-byte spad lines
+  ILA_ASSERT((cfg.conv_lanes > 0) && 
+             ((cfg.conv_lanes * cfg.conv_act_bits) % (NIC_MEM_ELEM_BYTEWIDTH * 8) == 0))
+    << "conv_lanes*conv_act_bits must be a multiple of " << NIC_MEM_ELEM_BYTEWIDTH * 8;
+  // the coarse-grained child and the ConvLayer function have 8 lanes and the
+  // default bitwidth profile
+  auto is_default_profile = (cfg.conv_weight_bits == WEIGHT_TOTAL_BITWIDTH) &&
+                            (cfg.conv_act_bits == ACT_TOTAL_BITWIDTH) &&
+                            (cfg.conv_psum_bits == PSUM_TOTAL_BITWIDTH);
+  ILA_ASSERT(((cfg.conv_lanes == CONV_VECTOR_SIZE) && is_default_profile) || 
+             !(cfg.conv_child_coarse || cfg.conv_layer_uf))
+    << "conv_child_coarse and conv_layer_uf require conv_lanes == " << CONV_VECTOR_SIZE
+    << " and the default bitwidth profile";
+  // output-stationary accumulation is a mode of the coarse-grained conv child
+  ILA_ASSERT(cfg.conv_child_coarse || !cfg.conv_output_stationary)
+    << "conv_output_stationary requires conv_child_coarse";
+  ILA_ASSERT(cfg.conv_child_coarse || !cfg.conv_coarse_stride_loop)
+    << "conv_coarse_stride_loop requires conv_child_coarse";
+  // the per-filter formulations don't have the filter groups
+  ILA_ASSERT(!cfg.conv_multi_filter || 
+             !(cfg.conv_child_coarse || cfg.conv_layer_uf || cfg.conv_weight_cache))
+    << "conv_multi_filter only works with the fine-grained conv child without weight cache";
+
+  // the grouped channel ranges are only in the fine-grained conv child
+  ILA_ASSERT(!cfg.conv_grouped || 
+             !(cfg.conv_child_coarse || cfg.conv_layer_uf || cfg.conv_multi_filter))
+    << "conv_grouped only works with the single-filter fine-grained conv child";
+
+  // the reduction child has the 16-bit activation layout of spad1
+  ILA_ASSERT(!cfg.reduction_child || (cfg.conv_act_bits == ACT_TOTAL_BITWIDTH))
+    << "reduction_child requires conv_act_bits == " << ACT_TOTAL_BITWIDTH;
+
+  // the pooled outputs are only finished in one step in output-stationary mode
+  ILA_ASSERT(!cfg.conv_fused_pool || 
+             (cfg.conv_output_stationary && !cfg.conv_coarse_stride_loop))
+    << "conv_fused_pool requires conv_output_stationary without conv_coarse_stride_loop";
+
+  // the ConvLayer function always reads the activations from the soc memory
+  // and writes the outputs at spad1 offset 0
+  ILA_ASSERT(!cfg.conv_act_spad1 || !cfg.conv_layer_uf)
+    << "conv_act_spad1 doesn't work with conv_layer_uf";
+
+  // the ConvLayer function takes byte-level memories
+  ILA_ASSERT(!cfg.mem_word_level || !cfg.conv_layer_uf)
+    << "conv_layer_uf requires byte-level memories";
+  ILA_ASSERT(!cfg.mem_word_level || !cfg.spad_bulk_dma)
+    << "spad_bulk_dma requires byte-level memories";
+
+  ILA_ASSERT(!cfg.mem_word_level || !cfg.spad_bulk_readback)
+    << "spad_bulk_readback requires byte-level memories";
+
+  ILA_ASSERT((cfg.vir_mem_burst_bytes % NIC_MEM_ELEM_BYTEWIDTH == 0) &&
+             (cfg.vir_mem_burst_bytes / NIC_MEM_ELEM_BYTEWIDTH < (1 << TOP_SLAVE_BURST_LEN_BITWIDTH)))
+    << "vir_mem_burst_bytes must be a multiple of " << NIC_MEM_ELEM_BYTEWIDTH
+    << " below " << (NIC_MEM_ELEM_BYTEWIDTH << TOP_SLAVE_BURST_LEN_BITWIDTH);
+
+  // the queued triggers wait for the conv child, which the ConvLayer function
+  // never starts, and the descriptor chain would launch layers in between
+  ILA_ASSERT((cfg.conv_cmd_queue_depth >= 0) &&
+             (cfg.conv_cmd_queue_depth < (1 << CONV_CMDQ_CNT_BITWIDTH)))
+    << "conv_cmd_queue_depth must be below " << (1 << CONV_CMDQ_CNT_BITWIDTH);
+  ILA_ASSERT((cfg.conv_cmd_queue_depth == 0) || !(cfg.conv_layer_uf || cfg.conv_desc_chain))
+    << "conv_cmd_queue_depth doesn't work with conv_layer_uf or conv_desc_chain";
+
+  // ConvLayer reads the weights from spad0 offset 0 and never runs the conv
+  // child, which the spad halves are owned by
+  ILA_ASSERT(!cfg.spad_double_buffer || !cfg.conv_layer_uf)
+    << "spad_double_buffer requires the conv child, not conv_layer_uf";
+
+  // one request is one 16-byte beat, i.e. one act vector of the fine-grained
+  // conv child; the other act/spad paths read the soc memory directly
+  ILA_ASSERT((cfg.axi_master_outstanding >= 0) &&
+             (cfg.axi_master_outstanding <= (1 << AXI_MASTER_RD_PTR_BITWIDTH)))
+    << "axi_master_outstanding must be at most " << (1 << AXI_MASTER_RD_PTR_BITWIDTH);
+  ILA_ASSERT((cfg.axi_master_latency >= 0) &&
+             (cfg.axi_master_latency < (1 << AXI_MASTER_RD_LAT_BITWIDTH)))
+    << "axi_master_latency must be below " << (1 << AXI_MASTER_RD_LAT_BITWIDTH);
+  ILA_ASSERT((cfg.axi_master_outstanding == 0) ||
+             ((cfg.conv_lanes == CONV_VECTOR_SIZE) && !cfg.conv_child_coarse &&
+              !cfg.conv_layer_uf && !cfg.conv_act_spad1 && !cfg.spad_bulk_dma))
+    << "axi_master_outstanding requires the 8-lane fine-grained conv child "
+    << "without conv_act_spad1 and spad_bulk_dma";
+
   // Define Instructions
-  DefineConfigInstr(m);
-  DefineSPADInstr(m);
-  DefineAccelConvTrigger(m);
+  DefineConfigInstr(m, cfg);
+  DefineSPADInstr(m, cfg);
+  DefineAccelConvTrigger(m, cfg);
 
-  DefineVirMemInstr(m);
+  DefineVirMemInstr(m, cfg);
   // Define child instructions
-  // // DefineAXIMasterChild(m);
-  DefineAccelConvChild(m);
-  DefineSPADInstrChild(m);
+  if (cfg.axi_master_outstanding > 0) {
+    DefineAXIMasterChild(m, cfg);
+  }
+  DefineAccelConvChild(m, cfg);
+  if (cfg.conv_child_coarse) {
+    DefineAccelConvChildCoarse(m, cfg);
+  }
+  if (cfg.fc_child) {
+    DefineAccelFCChild(m);
+  }
+  if (cfg.reduction_child) {
+    DefineAccelReductionChild(m);
+  }
+  if (cfg.conv_desc_chain) {
+    DefineAccelConvDescChild(m, cfg);
+  }
+  if (cfg.conv_cmd_queue_depth > 0) {
+    DefineAccelConvCmdQueueChild(m, cfg);
+  }
+  DefineSPADInstrChild(m, cfg);
+  if (cfg.spad_write_back) {
+    DefineSPADWriteBackChild(m, cfg);
+  }
 
   ILA_INFO << "spad0 base addr: " << std::hex << SPAD0_BASE_ADDR;
   ILA_INFO << "spad1 base addr: " << std::hex << SPAD1_BASE_ADDR;  
@@ -30,7 +30,7 @@
 namespace ilang {
 namespace hlscnn {
 
-void DefineInternalState(Ila& m) {
+void DefineInternalState(Ila& m, const ModelConfig& cfg) {
 
   ////////////////////////////////////
   // AXI master interface states
@@ -38,6 +38,16 @@ void DefineInternalState(Ila& m) {
   m.NewBvState(ACCEL_MASTER_AXI_CHILD_VALID_FLAG, ACCEL_MASTER_AXI_CHILD_VALID_FLAG_BITWIDTH);
   m.NewBvState(ACCEL_MASTER_AXI_CHILD_STATE, ACCEL_MASTER_AXI_CHILD_STATE_BITWIDTH);
   m.NewBvState(ACCEL_SPAD_WR_ADDR, ACCEL_SPAD_WR_ADDR_BITWIDTH);
+  if (cfg.axi_master_outstanding > 0) {
+    m.NewBvState(AXI_MASTER_RD_HEAD, AXI_MASTER_RD_PTR_BITWIDTH);
+    m.NewBvState(AXI_MASTER_RD_TAIL, AXI_MASTER_RD_PTR_BITWIDTH);
+    m.NewBvState(AXI_MASTER_RD_CNT, AXI_MASTER_RD_CNT_BITWIDTH);
+    for (auto i = 0; i < cfg.axi_master_outstanding; i++) {
+      m.NewBvState(GetStateName(AXI_MASTER_RD_DATA, i), AXI_MASTER_RD_DATA_BITWIDTH);
+      m.NewBvState(GetStateName(AXI_MASTER_RD_LAT, i), AXI_MASTER_RD_LAT_BITWIDTH);
+      m.NewBvState(GetStateName(AXI_MASTER_RD_SRC, i), AXI_MASTER_RD_SRC_BITWIDTH);
+    }
+  }
   
   ////////////////////////////////////
   // conv internal state
@@ -45,12 +55,71 @@ void DefineInternalState(Ila& m) {
   m.NewBvState(ACCEL_CONV_CHILD_VALID_FLAG, ACCEL_CONV_CHILD_VALID_FLAG_BITWIDTH);
   m.NewBvState(ACCEL_CONV_CHILD_STATE, ACCEL_CONV_CHILD_STATE_BITWIDTH);
 
+  ////////////////////////////////////
+  // FC internal state
+  ///////////////////////////////////
+  if (cfg.fc_child) {
+    m.NewBvState(ACCEL_FC_CHILD_VALID_FLAG, ACCEL_FC_CHILD_VALID_FLAG_BITWIDTH);
+    m.NewBvState(ACCEL_FC_CHILD_STATE, ACCEL_FC_CHILD_STATE_BITWIDTH);
+  }
+
+  ////////////////////////////////////
+  // reduction internal state
+  ///////////////////////////////////
+  if (cfg.reduction_child) {
+    m.NewBvState(ACCEL_REDUCTION_CHILD_VALID_FLAG, ACCEL_REDUCTION_CHILD_VALID_FLAG_BITWIDTH);
+    m.NewBvState(ACCEL_REDUCTION_CHILD_STATE, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH);
+  }
+
   ///////////////////////////////////
   // SPAD internal state
   ///////////////////////////////////
   m.NewBvState(SPAD_CHILD_VALID_FLAG, SPAD_CHILD_VALID_FLAG_BITWIDTH);
   m.NewBvState(SPAD_RD_WR_CNTR, SPAD_RD_WR_CNTR_BITWIDTH);
   m.NewBvState(SPAD_CHILD_TARGET, SPAD_CHILD_TARGET_BITWIDTH);
+  if (cfg.conv_desc_chain) {
+    m.NewBvState(SPAD_CHILD_SPAD_ADDR, SPAD_CHILD_SPAD_ADDR_BITWIDTH);
+  }
+  if (cfg.axi_master_outstanding > 0) {
+    m.NewBvState(SPAD_RD_REQ_CNTR, SPAD_RD_REQ_CNTR_BITWIDTH);
+  }
+  if (cfg.spad_double_buffer) {
+    m.NewBvState(SPAD0_CONV_HALF, SPAD_CONV_HALF_BITWIDTH);
+    m.NewBvState(SPAD1_CONV_HALF, SPAD_CONV_HALF_BITWIDTH);
+    if (cfg.conv_act_spad1) {
+      m.NewBvState(SPAD1_CONV_ACT_HALF, SPAD_CONV_HALF_BITWIDTH);
+    }
+  }
+
+  ///////////////////////////////////
+  // conv descriptor internal state
+  ///////////////////////////////////
+  if (cfg.conv_desc_chain) {
+    m.NewBvState(CONV_DESC_CHILD_VALID_FLAG, CONV_DESC_CHILD_VALID_FLAG_BITWIDTH);
+    m.NewBvState(CONV_DESC_ADDR, CONV_DESC_ADDR_BITWIDTH);
+    m.NewBvState(CONV_DESC_STATE, CONV_DESC_STATE_BITWIDTH);
+  }
+
+  ///////////////////////////////////
+  // spad1 write-back internal state
+  ///////////////////////////////////
+  if (cfg.spad_write_back) {
+    m.NewBvState(SPAD_WB_CHILD_VALID_FLAG, SPAD_WB_CHILD_VALID_FLAG_BITWIDTH);
+    m.NewBvState(SPAD_WB_CNTR, SPAD_WB_CNTR_BITWIDTH);
+    m.NewBvState(SPAD_WB_SPAD_ADDR, SPAD_WB_SPAD_ADDR_BITWIDTH);
+    m.NewBvState(SPAD_WB_SOC_ADDR, SPAD_WB_SOC_ADDR_BITWIDTH);
+    m.NewBvState(SPAD_WB_LENGTH, SPAD_WB_LENGTH_BITWIDTH);
+  }
+
+  ///////////////////////////////////
+  // conv command queue internal state
+  ///////////////////////////////////
+  if (cfg.conv_cmd_queue_depth > 0) {
+    m.NewBvState(CONV_CMDQ_CNT, CONV_CMDQ_CNT_BITWIDTH);
+    for (auto i = 0; i < cfg.conv_cmd_queue_depth; i++) {
+      m.NewBvState(GetStateName(CONV_CMDQ_ENTRY, i), CONV_CMDQ_ENTRY_BITWIDTH);
+    }
+  }
 
 }
 
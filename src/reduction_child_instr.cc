@@ -0,0 +1,212 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: reduction_child_instr.cc
+
+// This file contains the reduction (pooling) child started by AccelReductionTrigger.
+// It pools the channel-blocked activations in spad1 (chan_block -> row -> col ->
+// CHANNEL_BLOCK_SIZE lanes, the layout of the conv outputs) with non-overlapping
+// pool_size x pool_size windows, or over the whole input map if pool_size is 0.
+// Each accumulate instruction reads one input vector and updates all the lanes,
+// the output instruction applies average/bias/activation function and writes
+// the output vector to spad1, in the same layout.
+
+#include <ilang/ilang++.h>
+#include <hlscnn/hlscnn_top.h>
+#include <vector>
+
+namespace ilang {
+namespace hlscnn {
+
+// zero-extend the loop states and params to the address bitwidth
+static ExprRef ReductionZExt(const ExprRef& val) {
+  return Concat(BvConst(0, REDUCTION_INPUT_BASE_ADDR_BITWIDTH - val.bit_width()), val);
+}
+
+void DefineAccelReductionChild(Ila& m) {
+  auto child = m.NewChild("Accel_Reduction_Child");
+  auto child_valid_flag = m.state(ACCEL_REDUCTION_CHILD_VALID_FLAG);
+  child.SetValid(child_valid_flag == ACCEL_REDUCTION_CHILD_VALID);
+
+  // Declare child states
+  child.NewBvState(REDUCTION_CHILD_CHAN_BLOCK_ID, REDUCTION_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+  child.NewBvState(REDUCTION_CHILD_OUT_ROW_ID, REDUCTION_CHILD_OUT_ROW_ID_BITWIDTH);
+  child.NewBvState(REDUCTION_CHILD_OUT_COL_ID, REDUCTION_CHILD_OUT_COL_ID_BITWIDTH);
+  child.NewBvState(REDUCTION_CHILD_WIN_ROW_ID, REDUCTION_CHILD_WIN_ROW_ID_BITWIDTH);
+  child.NewBvState(REDUCTION_CHILD_WIN_COL_ID, REDUCTION_CHILD_WIN_COL_ID_BITWIDTH);
+  for (auto i = 0; i < CHANNEL_BLOCK_SIZE; i++) {
+    child.NewBvState(GetStateName(REDUCTION_CHILD_ACC_ARRAY, i),
+                     REDUCTION_CHILD_ACC_ARRAY_BITWIDTH);
+  }
+
+  auto state = child.state(ACCEL_REDUCTION_CHILD_STATE);
+  auto is_child_valid =
+    (child.state(ACCEL_REDUCTION_CHILD_VALID_FLAG) == ACCEL_REDUCTION_CHILD_VALID);
+
+  auto chan_block = child.state(REDUCTION_CHILD_CHAN_BLOCK_ID);
+  auto out_row = child.state(REDUCTION_CHILD_OUT_ROW_ID);
+  auto out_col = child.state(REDUCTION_CHILD_OUT_COL_ID);
+  auto win_row = child.state(REDUCTION_CHILD_WIN_ROW_ID);
+  auto win_col = child.state(REDUCTION_CHILD_WIN_COL_ID);
+
+  std::vector<ExprRef> acc_array;
+  for (auto i = 0; i < CHANNEL_BLOCK_SIZE; i++) {
+    acc_array.push_back(child.state(GetStateName(REDUCTION_CHILD_ACC_ARRAY, i)));
+  }
+
+  // loop bounds and spad1 addresses are computed in 32 bits
+  auto ext_bitwidth = REDUCTION_INPUT_BASE_ADDR_BITWIDTH;
+
+  auto input_rows = ReductionZExt(child.state(REDUCTION_INPUT_ROW_NUM));
+  auto input_cols = ReductionZExt(child.state(REDUCTION_INPUT_COL_NUM));
+  auto input_chans = ReductionZExt(child.state(REDUCTION_INPUT_CHAN_NUM));
+  auto pool_size = ReductionZExt(child.state(REDUCTION_POOL_SIZE));
+  auto is_avg = (child.state(REDUCTION_POOL_AVG) == 1);
+
+  // a window larger than the input map pools the whole map
+  auto win_rows = Ite((pool_size == 0) | (pool_size > input_rows), input_rows, pool_size);
+  auto win_cols = Ite((pool_size == 0) | (pool_size > input_cols), input_cols, pool_size);
+  auto out_rows = input_rows / win_rows;
+  auto out_cols = input_cols / win_cols;
+  auto last_chan_block = Ite(URem(input_chans, BvConst(CHANNEL_BLOCK_SIZE, ext_bitwidth)) == 0,
+                             input_chans / CHANNEL_BLOCK_SIZE,
+                             input_chans / CHANNEL_BLOCK_SIZE + 1);
+
+  auto vec_bytes = CHANNEL_BLOCK_SIZE * (ACT_TOTAL_BITWIDTH/8);
+
+  { // instr ---- start the reduction loops
+    auto instr = child.NewInstr("accel_reduction_start");
+    instr.SetDecode(is_child_valid & (state == REDUCTION_CHILD_STATE_IDLE));
+
+    instr.SetUpdate(chan_block, BvConst(0, REDUCTION_CHILD_CHAN_BLOCK_ID_BITWIDTH));
+    instr.SetUpdate(out_row, BvConst(0, REDUCTION_CHILD_OUT_ROW_ID_BITWIDTH));
+    instr.SetUpdate(out_col, BvConst(0, REDUCTION_CHILD_OUT_COL_ID_BITWIDTH));
+    instr.SetUpdate(win_row, BvConst(0, REDUCTION_CHILD_WIN_ROW_ID_BITWIDTH));
+    instr.SetUpdate(win_col, BvConst(0, REDUCTION_CHILD_WIN_COL_ID_BITWIDTH));
+
+    instr.SetUpdate(state, BvConst(REDUCTION_CHILD_STATE_ACCUM,
+                                   ACCEL_REDUCTION_CHILD_STATE_BITWIDTH));
+  }
+
+  { // instr ---- reduction done
+    auto instr = child.NewInstr("accel_reduction_done");
+    instr.SetDecode(is_child_valid & (state == REDUCTION_CHILD_STATE_DONE));
+
+    instr.SetUpdate(state,
+      BvConst(REDUCTION_CHILD_STATE_IDLE, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH));
+    instr.SetUpdate(child.state(ACCEL_REDUCTION_CHILD_VALID_FLAG),
+      BvConst(ACCEL_REDUCTION_CHILD_INVALID, ACCEL_REDUCTION_CHILD_VALID_FLAG_BITWIDTH));
+  }
+
+  { // instr ---- reduce one input vector of the window into the accumulators
+    auto instr = child.NewInstr("accel_reduction_accum");
+    instr.SetDecode(is_child_valid & (state == REDUCTION_CHILD_STATE_ACCUM));
+
+    auto in_row = ReductionZExt(out_row) * win_rows + ReductionZExt(win_row);
+    auto in_col = ReductionZExt(out_col) * win_cols + ReductionZExt(win_col);
+    auto in_addr = child.state(REDUCTION_INPUT_BASE_ADDR) +
+      ((ReductionZExt(chan_block) * input_rows + in_row) * input_cols + in_col) * vec_bytes;
+
+    auto spad1 = child.state(SCRATCH_PAD_1);
+    auto is_first = (win_row == 0) & (win_col == 0);
+    auto psum_zero = BvConst(0, PSUM_TOTAL_BITWIDTH);
+
+    auto acts = MemLoadActVector(spad1, in_addr, CHANNEL_BLOCK_SIZE);
+    for (auto i = 0; i < CHANNEL_BLOCK_SIZE; i++) {
+      auto act = acts[i];
+      // adding the first element to zero only converts it into the psum type
+      auto acc_next = Ite(is_first, ReduceAddPsum(psum_zero, act),
+                          Ite(is_avg, ReduceAddPsum(acc_array[i], act),
+                                      ReduceMaxPsum(acc_array[i], act)));
+      instr.SetUpdate(acc_array[i], acc_next);
+    }
+
+    auto is_last_win_col = (ReductionZExt(win_col) >= win_cols - 1);
+    auto is_last_win_row = (ReductionZExt(win_row) >= win_rows - 1);
+
+    auto next_win_col = Ite(is_last_win_col, BvConst(0, win_col.bit_width()), win_col + 1);
+    auto next_win_row = Ite(is_last_win_col,
+                            Ite(is_last_win_row, BvConst(0, win_row.bit_width()), win_row + 1),
+                            win_row);
+    auto next_state = Ite(is_last_win_col & is_last_win_row,
+                          BvConst(REDUCTION_CHILD_STATE_OUT, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH),
+                          BvConst(REDUCTION_CHILD_STATE_ACCUM, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH));
+
+    instr.SetUpdate(win_col, next_win_col);
+    instr.SetUpdate(win_row, next_win_row);
+    instr.SetUpdate(state, next_state);
+  }
+
+  { // instr ---- write the output vector of the window
+    auto instr = child.NewInstr("accel_reduction_out");
+    instr.SetDecode(is_child_valid & (state == REDUCTION_CHILD_STATE_OUT));
+
+    auto out_row_ext = ReductionZExt(out_row);
+    auto out_col_ext = ReductionZExt(out_col);
+    auto out_addr = child.state(REDUCTION_OUTPUT_BASE_ADDR) +
+      ((ReductionZExt(chan_block) * out_rows + out_row_ext) * out_cols + out_col_ext) * vec_bytes;
+
+    auto en_bias = child.state(REDUCTION_ENABLE_BIAS);
+    auto bias = child.state(REDUCTION_BIAS);
+    auto act_func = child.state(REDUCTION_ACT_FUNC);
+    auto relu_threshold = child.state(REDUCTION_RELU_THRESHOLD);
+    auto win_elems = win_rows * win_cols;
+
+    auto spad1 = child.state(SCRATCH_PAD_1);
+    std::vector<ExprRef> out_acts;
+    for (auto i = 0; i < CHANNEL_BLOCK_SIZE; i++) {
+      auto out_psum = Ite(is_avg, ReduceAvgPsum(acc_array[i], win_elems), acc_array[i]);
+      out_psum = Ite(en_bias != 0, ConvAddBias(out_psum, bias), out_psum);
+      // act func encodings: 0 none, 1 ReLU, 2 ReLU threshold
+      out_psum = Ite(act_func == 1, PsumRelu(out_psum),
+                     Ite(act_func == 2, PsumReluThreshold(out_psum, relu_threshold), out_psum));
+
+      out_acts.push_back(Psum2Act(out_psum));
+    }
+    instr.SetUpdate(spad1, MemStoreActVector(spad1, out_addr, out_acts));
+
+    auto is_last_col = (out_col_ext >= out_cols - 1);
+    auto is_last_row = is_last_col & (out_row_ext >= out_rows - 1);
+    auto is_last_chan_blk = is_last_row & (ReductionZExt(chan_block) >= last_chan_block - 1);
+
+    auto next_out_col = Ite(is_last_col, BvConst(0, out_col.bit_width()), out_col + 1);
+    auto next_out_row = Ite(is_last_row, BvConst(0, out_row.bit_width()),
+                            Ite(is_last_col, out_row + 1, out_row));
+    auto next_chan_block = Ite(is_last_chan_blk, BvConst(0, chan_block.bit_width()),
+                               Ite(is_last_row, chan_block + 1, chan_block));
+
+    instr.SetUpdate(out_col, next_out_col);
+    instr.SetUpdate(out_row, next_out_row);
+    instr.SetUpdate(chan_block, next_chan_block);
+
+    auto next_state =
+      Ite(is_last_chan_blk,
+          BvConst(REDUCTION_CHILD_STATE_DONE, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH),
+          BvConst(REDUCTION_CHILD_STATE_ACCUM, ACCEL_REDUCTION_CHILD_STATE_BITWIDTH));
+    instr.SetUpdate(state, next_state);
+  }
+}
+
+} // namespace hlscnn
+} // namespace ilang
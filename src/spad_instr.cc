@@ -26,11 +26,12 @@
 
 #include <ilang/ilang++.h>
 #include <hlscnn/hlscnn_top.h>
+#include <vector>
 
 namespace ilang {
 namespace hlscnn {
 
-void DefineSPADInstr(Ila& m) {
+void DefineSPADInstr(Ila& m, const ModelConfig& cfg) {
   // spad write/read input condition
   auto is_write = (m.input(TOP_SLAVE_IF_WR) & ~m.input(TOP_SLAVE_IF_RD));
   auto is_read = (~m.input(TOP_SLAVE_IF_WR) & m.input(TOP_SLAVE_IF_RD));
@@ -39,6 +40,9 @@ void DefineSPADInstr(Ila& m) {
   // offset from the CPU.""
   auto masked_addr = Concat(BvConst(0, 8), 
                             Extract(m.input(TOP_SLAVE_ADDR_IN), 23, 0));
+  // single-line reads are the ones without a bulk length
+  auto is_line_read = (cfg.spad_bulk_readback) ?
+    is_read & (m.input(TOP_SLAVE_RD_LEN) <= 1) : is_read;
 
   {// write data into SPAD0
     auto instr = m.NewInstr("SPAD0_DATA_WR");
@@ -51,6 +55,12 @@ void DefineSPADInstr(Ila& m) {
                     BvConst(0, SPAD_RD_WR_CNTR_BITWIDTH));
     instr.SetUpdate(m.state(SPAD_CHILD_TARGET),
                     BvConst(0, SPAD_CHILD_TARGET_BITWIDTH));
+    if (cfg.conv_desc_chain) {
+      instr.SetUpdate(m.state(SPAD_CHILD_SPAD_ADDR), masked_addr - SPAD0_BASE_ADDR);
+    }
+    if (cfg.axi_master_outstanding > 0) {
+      instr.SetUpdate(m.state(SPAD_RD_REQ_CNTR), BvConst(0, SPAD_RD_REQ_CNTR_BITWIDTH));
+    }
   }
 
   {// write data into SPAD1
@@ -65,6 +75,12 @@ void DefineSPADInstr(Ila& m) {
                     BvConst(0, SPAD_RD_WR_CNTR_BITWIDTH));
     instr.SetUpdate(m.state(SPAD_CHILD_TARGET),
                     BvConst(1, SPAD_CHILD_TARGET_BITWIDTH));
+    if (cfg.conv_desc_chain) {
+      instr.SetUpdate(m.state(SPAD_CHILD_SPAD_ADDR), masked_addr - SPAD1_BASE_ADDR);
+    }
+    if (cfg.axi_master_outstanding > 0) {
+      instr.SetUpdate(m.state(SPAD_RD_REQ_CNTR), BvConst(0, SPAD_RD_REQ_CNTR_BITWIDTH));
+    }
   }
 
   // AXI read instructions for SPAD
@@ -72,7 +88,7 @@ void DefineSPADInstr(Ila& m) {
     auto instr = m.NewInstr("SPAD0_DATA_RD");
     auto is_spad0_addr = (masked_addr >= SPAD0_BASE_ADDR) & (masked_addr < SPAD1_BASE_ADDR);
 
-    instr.SetDecode(is_read & is_spad0_addr);
+    instr.SetDecode(is_line_read & is_spad0_addr);
 
     auto spad = m.state(SCRATCH_PAD_0);
     auto spad_addr = masked_addr - SPAD0_BASE_ADDR;
@@ -80,11 +96,9 @@ void DefineSPADInstr(Ila& m) {
     auto vir_out_mem = m.state(VIRTUAL_OUTPUT_MEMORY);
     auto vir_out_mem_next = vir_out_mem;
     
+    auto acts = MemLoadActVector(spad, spad_addr, 8);
     for (auto i = 0; i < 8; i++) {
-      auto act_byte_1 = Load(spad, spad_addr + 2*i+1);
-      auto act_byte_0 = Load(spad, spad_addr + 2*i);
-      auto act = Concat(act_byte_1, act_byte_0);
-      vir_out_mem_next = Store(vir_out_mem_next, masked_addr + 2*i, act);
+      vir_out_mem_next = Store(vir_out_mem_next, masked_addr + 2*i, acts[i]);
     }
     instr.SetUpdate(vir_out_mem, vir_out_mem_next);
   }
@@ -93,7 +107,7 @@ void DefineSPADInstr(Ila& m) {
     auto instr = m.NewInstr("SPAD1_DATA_RD");
     auto is_spad1_addr = (masked_addr >= SPAD1_BASE_ADDR) & (masked_addr < MEM_ADDR_MAX);
 
-    instr.SetDecode(is_read & is_spad1_addr);
+    instr.SetDecode(is_line_read & is_spad1_addr);
 
     auto spad = m.state(SCRATCH_PAD_1);
     auto spad_addr = masked_addr - SPAD1_BASE_ADDR;
@@ -101,17 +115,54 @@ void DefineSPADInstr(Ila& m) {
     auto vir_out_mem = m.state(VIRTUAL_OUTPUT_MEMORY);
     auto vir_out_mem_next = vir_out_mem;
 
+    auto acts = MemLoadActVector(spad, spad_addr, 8);
     for (auto i = 0; i < 8; i++) {
-      auto act_byte_1 = Load(spad, spad_addr + 2*i+1);
-      auto act_byte_0 = Load(spad, spad_addr + 2*i);
-      auto act = Concat(act_byte_1, act_byte_0);
-      vir_out_mem_next = Store(vir_out_mem_next, masked_addr + 2*i, act);
+      vir_out_mem_next = Store(vir_out_mem_next, masked_addr + 2*i, acts[i]);
     }
     instr.SetUpdate(vir_out_mem, vir_out_mem_next);
   }
+
+  if (cfg.spad_bulk_readback) {
+    // read top_slave_rd_len spad lines into the output memory at once
+    std::vector<std::string> instr_names = {"SPAD0_BULK_RD", "SPAD1_BULK_RD"};
+    std::vector<std::string> spad_names = {SCRATCH_PAD_0, SCRATCH_PAD_1};
+    std::vector<int> spad_base_addrs = {SPAD0_BASE_ADDR, SPAD1_BASE_ADDR};
+    std::vector<int> spad_end_addrs = {SPAD1_BASE_ADDR, MEM_ADDR_MAX};
+
+    for (auto t = 0; t < 2; t++) {
+      auto instr = m.NewInstr(instr_names[t]);
+      auto is_spad_addr = (masked_addr >= spad_base_addrs[t]) &
+                          (masked_addr < spad_end_addrs[t]);
+      auto rd_len = m.input(TOP_SLAVE_RD_LEN);
+
+      instr.SetDecode(is_read & (rd_len > 1) & is_spad_addr);
+
+      auto vir_out_mem = m.state(VIRTUAL_OUTPUT_MEMORY);
+      auto num_elems = Concat(BvConst(0, TOP_SLAVE_ADDR_IN_BITWIDTH - rd_len.bit_width()), rd_len) *
+                       (NIC_MEM_ELEM_BYTEWIDTH / (ACT_TOTAL_BITWIDTH/8));
+      std::vector<ExprRef> read_in = {vir_out_mem, m.state(spad_names[t]), masked_addr,
+                                      masked_addr - spad_base_addrs[t], num_elems};
+      instr.SetUpdate(vir_out_mem, SpadBulkRead(read_in));
+    }
+  }
+}
+
+// spad offset of the current transfer: latched with conv_desc_chain, which
+// also starts the child without a host write, and the offset of the host
+// write addr otherwise
+static ExprRef SpadChildAddr(const Ila& m, const ModelConfig& cfg, const int& spad_base_addr) {
+  if (cfg.conv_desc_chain) {
+    return m.state(SPAD_CHILD_SPAD_ADDR);
+  }
+  // masked address.
+  // "Mask off the top 8 bits, which represent the device memory map
+  // offset from the CPU.""
+  auto masked_addr = Concat(BvConst(0, 8), 
+                            Extract(m.input(TOP_SLAVE_ADDR_IN), 23, 0));
+  return masked_addr - spad_base_addr;
 }
 
-void DefineSPADInstrChild(Ila& m) {
+void DefineSPADInstrChild(Ila& m, const ModelConfig& cfg) {
   auto child = m.NewChild("SPAD_child");
   auto valid_flag = m.state(SPAD_CHILD_VALID_FLAG);
   child.SetValid(valid_flag == 1);
@@ -120,18 +171,103 @@ void DefineSPADInstrChild(Ila& m) {
   auto rd_wr_length = m.state(CFG_REG_SOC_MEM_RD_WR_LENGTH);
   auto target = m.state(SPAD_CHILD_TARGET);
   
-  // masked address.
-  // "Mask off the top 8 bits, which represent the device memory map
-  // offset from the CPU.""
-  auto masked_addr = Concat(BvConst(0, 8), 
-                            Extract(m.input(TOP_SLAVE_ADDR_IN), 23, 0));
   auto soc_mem_addr = m.state(CFG_REG_SOC_MEM_BASE_ADDR);
   auto axi_addr_out = m.state(TOP_MASTER_RD_ADDR_OUT);
   
+  if (cfg.spad_bulk_dma) {
+    // child instructions copying the whole transfer into SPAD0/SPAD1 at once
+    std::vector<std::string> instr_names = {"spad_0_child_bulk_wr", "spad_1_child_bulk_wr"};
+    std::vector<std::string> spad_names = {SCRATCH_PAD_0, SCRATCH_PAD_1};
+    std::vector<int> spad_base_addrs = {SPAD0_BASE_ADDR, SPAD1_BASE_ADDR};
+
+    for (auto t = 0; t < 2; t++) {
+      auto instr = child.NewInstr(instr_names[t]);
+      auto spad = m.state(spad_names[t]);
+      auto spad_addr = SpadChildAddr(m, cfg, spad_base_addrs[t]) + cntr*16;
+
+      // a transfer into the spad half of a running conv layer waits for it,
+      // transfers must not cross the middle of the spad
+      auto is_decode = (valid_flag == 1 & cntr < rd_wr_length & target == t);
+      if (cfg.spad_double_buffer) {
+        is_decode = is_decode & ~SpadIsConvOwned(m, t, spad_addr, cfg.conv_act_spad1);
+      }
+      instr.SetDecode(is_decode);
+
+      // the AXI master addr port is left at the last beat of the transfer
+      instr.SetUpdate(axi_addr_out, soc_mem_addr + (rd_wr_length - 1)*16);
+
+      auto soc_addr = soc_mem_addr + cntr*16;
+      auto num_bytes = (rd_wr_length - cntr)*16;
+      std::vector<ExprRef> copy_in = {spad, m.state(VIRTUAL_SOC_MEMORY),
+                                      spad_addr, soc_addr, num_bytes};
+      instr.SetUpdate(spad, SpadBulkCopy(copy_in));
+
+      instr.SetUpdate(cntr, rd_wr_length);
+      instr.SetUpdate(valid_flag, BvConst(0, SPAD_CHILD_VALID_FLAG_BITWIDTH));
+    }
+    return;
+  }
+
+  if (cfg.axi_master_outstanding > 0) {
+    // the beats are requested through the AXI master child, ahead of the
+    // responses written into SPAD0/SPAD1
+    std::vector<std::string> req_names = {"spad_0_child_rd_req", "spad_1_child_rd_req"};
+    std::vector<std::string> wr_names = {"spad_0_child_wr", "spad_1_child_wr"};
+    std::vector<std::string> spad_names = {SCRATCH_PAD_0, SCRATCH_PAD_1};
+    std::vector<int> spad_base_addrs = {SPAD0_BASE_ADDR, SPAD1_BASE_ADDR};
+    auto req_cntr = m.state(SPAD_RD_REQ_CNTR);
+
+    for (auto t = 0; t < 2; t++) {
+      { // issue the read request of the next beat
+        auto instr = child.NewInstr(req_names[t]);
+        auto spad_addr = SpadChildAddr(m, cfg, spad_base_addrs[t]) + req_cntr*16;
+
+        // a beat into the spad half of a running conv layer is not requested
+        // until it is done, so its response cannot hold up the AXI master
+        auto is_decode = (valid_flag == 1 & req_cntr < rd_wr_length & target == t &
+                          AXIMasterRdReqReady(m, cfg));
+        if (cfg.spad_double_buffer) {
+          is_decode = is_decode & ~SpadIsConvOwned(m, t, spad_addr, cfg.conv_act_spad1);
+        }
+        instr.SetDecode(is_decode);
+
+        SetAXIMasterRdReq(instr, m, cfg, soc_mem_addr + req_cntr*16, AXI_MASTER_RD_SRC_SPAD);
+        instr.SetUpdate(req_cntr, req_cntr + 1);
+      }
+
+      { // write the oldest response into the spad
+        auto instr = child.NewInstr(wr_names[t]);
+        auto spad = m.state(spad_names[t]);
+        auto spad_addr = SpadChildAddr(m, cfg, spad_base_addrs[t]) + cntr*16;
+
+        auto is_decode = (valid_flag == 1 & cntr < rd_wr_length & target == t &
+                          AXIMasterRdRespValid(m, cfg, AXI_MASTER_RD_SRC_SPAD));
+        if (cfg.spad_double_buffer) {
+          is_decode = is_decode & ~SpadIsConvOwned(m, t, spad_addr, cfg.conv_act_spad1);
+        }
+        instr.SetDecode(is_decode);
+
+        instr.SetUpdate(spad, MemStoreWord(spad, spad_addr, AXIMasterRdRespData(m, cfg)));
+        SetAXIMasterRdResp(instr, m, cfg);
+
+        instr.SetUpdate(cntr, cntr+1);
+        instr.SetUpdate(valid_flag, Ite(cntr < rd_wr_length - 1,
+                                    valid_flag, BvConst(0, SPAD_CHILD_VALID_FLAG_BITWIDTH)));
+      }
+    }
+    return;
+  }
 
   { // child instructions for reading data from external memory to SPAD0
     auto instr = child.NewInstr("spad_0_child_wr");
-    instr.SetDecode(valid_flag == 1 & cntr < rd_wr_length & target == 0);
+    auto spad_addr = SpadChildAddr(m, cfg, SPAD0_BASE_ADDR) + cntr*16;
+
+    // a beat into the spad half of a running conv layer waits for it
+    auto is_decode = (valid_flag == 1 & cntr < rd_wr_length & target == 0);
+    if (cfg.spad_double_buffer) {
+      is_decode = is_decode & ~SpadIsConvOwned(m, 0, spad_addr, cfg.conv_act_spad1);
+    }
+    instr.SetDecode(is_decode);
     
     // this part model the AXI master interface addr port
     // assume the cntr*16 value wouldn't overflow
@@ -140,13 +276,16 @@ void DefineSPADInstrChild(Ila& m) {
 
     // this part takes the data from the virtual memory for simulation
     auto spad = m.state(SCRATCH_PAD_0);
-    auto spad_addr = masked_addr - SPAD0_BASE_ADDR + cntr*16;
     auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
 
     auto spad_next = spad;
 
-    for (auto i = 0; i < 16; i++) {
-      spad_next = Store(spad_next, spad_addr + i, Load(vir_mem, soc_mem_addr + i));
+    if (MemIsWordLevel(spad)) {
+      spad_next = MemStoreWord(spad, spad_addr, MemLoadWord(vir_mem, soc_mem_addr));
+    } else {
+      for (auto i = 0; i < 16; i++) {
+        spad_next = Store(spad_next, spad_addr + i, Load(vir_mem, soc_mem_addr + i));
+      }
     }
 
     instr.SetUpdate(spad, spad_next);
@@ -159,7 +298,14 @@ void DefineSPADInstrChild(Ila& m) {
 
   { // child instruction for reading data from external memory to SPAD1
     auto instr = child.NewInstr("spad_1_child_wr");
-    instr.SetDecode(valid_flag == 1 & cntr < rd_wr_length & target == 1);
+    auto spad_addr = SpadChildAddr(m, cfg, SPAD1_BASE_ADDR) + cntr*16;
+
+    // a beat into the spad half of a running conv layer waits for it
+    auto is_decode = (valid_flag == 1 & cntr < rd_wr_length & target == 1);
+    if (cfg.spad_double_buffer) {
+      is_decode = is_decode & ~SpadIsConvOwned(m, 1, spad_addr, cfg.conv_act_spad1);
+    }
+    instr.SetDecode(is_decode);
 
     // this part model the AXI master interface addr port
     // assume the cntr*16 value wouldn't overflow
@@ -168,13 +314,16 @@ void DefineSPADInstrChild(Ila& m) {
 
     // this part takes the data from the virtual memory for simulation
     auto spad = m.state(SCRATCH_PAD_1);
-    auto spad_addr = masked_addr - SPAD1_BASE_ADDR + cntr*16;
     auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
 
     auto spad_next = spad;
 
-    for (auto i = 0; i < 16; i++) {
-      spad_next = Store(spad_next, spad_addr + i, Load(vir_mem, soc_mem_addr + i));
+    if (MemIsWordLevel(spad)) {
+      spad_next = MemStoreWord(spad, spad_addr, MemLoadWord(vir_mem, soc_mem_addr));
+    } else {
+      for (auto i = 0; i < 16; i++) {
+        spad_next = Store(spad_next, spad_addr + i, Load(vir_mem, soc_mem_addr + i));
+      }
     }
 
     instr.SetUpdate(spad, spad_next);
@@ -0,0 +1,117 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: spad_wb_child_instr.cc
+
+// This file contains the spad1 write-back child, the AXI master write
+// counterpart of the SPAD child. It copies CFG_REG_SOC_MEM_RD_WR_LENGTH 16-byte
+// lines of spad1 into the virtual soc memory at CFG_REG_SOC_MEM_BASE_ADDR, both
+// latched when it starts (it doesn't start with a zero length). The
+// host starts it by writing the spad1 offset of the region into AccelSpadCFG;
+// a conv layer with ENABLE_WB starts it on its outputs, at spad1 offset 0 (or
+// AccelConvOutputsBaseAddr with ModelConfig::conv_act_spad1).
+
+#include <ilang/ilang++.h>
+#include <hlscnn/hlscnn_top.h>
+#include <vector>
+
+namespace ilang {
+namespace hlscnn {
+
+void SetSPADWriteBackStart(InstrRef& instr, Ila& m, const ExprRef& is_start,
+                           const ExprRef& spad_addr) {
+  auto valid_flag = m.state(SPAD_WB_CHILD_VALID_FLAG);
+  auto cntr = m.state(SPAD_WB_CNTR);
+  auto spad_base = m.state(SPAD_WB_SPAD_ADDR);
+  auto soc_base = m.state(SPAD_WB_SOC_ADDR);
+  auto length = m.state(SPAD_WB_LENGTH);
+
+  // an empty region has nothing to write back, the child would never finish
+  auto rd_wr_length = m.state(CFG_REG_SOC_MEM_RD_WR_LENGTH);
+  auto is_valid_start = is_start & (rd_wr_length != 0);
+
+  instr.SetUpdate(valid_flag,
+                  Ite(is_valid_start, BvConst(1, SPAD_WB_CHILD_VALID_FLAG_BITWIDTH), valid_flag));
+  instr.SetUpdate(cntr, Ite(is_valid_start, BvConst(0, SPAD_WB_CNTR_BITWIDTH), cntr));
+  instr.SetUpdate(spad_base, Ite(is_valid_start, spad_addr, spad_base));
+  instr.SetUpdate(soc_base,
+                  Ite(is_valid_start, m.state(CFG_REG_SOC_MEM_BASE_ADDR), soc_base));
+  instr.SetUpdate(length, Ite(is_valid_start, rd_wr_length, length));
+}
+
+void DefineSPADWriteBackChild(Ila& m, const ModelConfig& cfg) {
+  auto child = m.NewChild("SPAD_WB_child");
+  auto valid_flag = m.state(SPAD_WB_CHILD_VALID_FLAG);
+  child.SetValid(valid_flag == 1);
+
+  auto cntr = m.state(SPAD_WB_CNTR);
+  auto rd_wr_length = m.state(SPAD_WB_LENGTH);
+  auto soc_mem_base = m.state(SPAD_WB_SOC_ADDR);
+  auto spad_base = m.state(SPAD_WB_SPAD_ADDR);
+  auto axi_addr_out = m.state(TOP_MASTER_WR_ADDR_OUT);
+
+  auto spad = m.state(SCRATCH_PAD_1);
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+
+  if (cfg.spad_bulk_dma) {
+    // child instruction writing the whole region back at once
+    auto instr = child.NewInstr("spad_1_child_bulk_wb");
+    instr.SetDecode(valid_flag == 1 & cntr < rd_wr_length);
+
+    // the AXI master addr port is left at the last beat of the transfer
+    instr.SetUpdate(axi_addr_out, soc_mem_base + (rd_wr_length - 1)*16);
+
+    // SpadBulkCopy(dst, src, ...): spad1 -> soc memory
+    auto soc_addr = soc_mem_base + cntr*16;
+    auto spad_addr = spad_base + cntr*16;
+    auto num_bytes = (rd_wr_length - cntr)*16;
+    std::vector<ExprRef> copy_in = {vir_mem, spad, soc_addr, spad_addr, num_bytes};
+    instr.SetUpdate(vir_mem, SpadBulkCopy(copy_in));
+
+    instr.SetUpdate(cntr, rd_wr_length);
+    instr.SetUpdate(valid_flag, BvConst(0, SPAD_WB_CHILD_VALID_FLAG_BITWIDTH));
+    return;
+  }
+
+  { // child instruction writing one 16-byte line of spad1 to the soc memory
+    auto instr = child.NewInstr("spad_1_child_wb");
+    instr.SetDecode(valid_flag == 1 & cntr < rd_wr_length);
+
+    // this part model the AXI master interface write addr port
+    // assume the cntr*16 value wouldn't overflow
+    auto soc_mem_addr = soc_mem_base + cntr*16;
+    instr.SetUpdate(axi_addr_out, soc_mem_addr);
+
+    auto spad_addr = spad_base + cntr*16;
+    instr.SetUpdate(vir_mem, MemStoreWord(vir_mem, soc_mem_addr, MemLoadWord(spad, spad_addr)));
+
+    // control signal
+    instr.SetUpdate(cntr, cntr+1);
+    instr.SetUpdate(valid_flag, Ite(cntr < rd_wr_length - 1,
+                                valid_flag, BvConst(0, SPAD_WB_CHILD_VALID_FLAG_BITWIDTH)));
+  }
+}
+
+} // namespace hlscnn
+} // namespace ilang
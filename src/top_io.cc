@@ -30,7 +30,7 @@
 namespace ilang {
 namespace hlscnn {
 
-void DefineTopIO(Ila& m) {
+void DefineTopIO(Ila& m, const ModelConfig& cfg) {
 
   // HLSCNN has two AXI interface, a slave interface and a master interface
   
@@ -61,6 +61,16 @@ void DefineTopIO(Ila& m) {
   m.NewBvInput(TOP_SLAVE_DATA_IN_14, TOP_SLAVE_DATA_IN_BITWIDTH);
   m.NewBvInput(TOP_SLAVE_DATA_IN_15, TOP_SLAVE_DATA_IN_BITWIDTH);
 
+  if (cfg.vir_mem_burst_bytes > 0) {
+    m.NewBvInput(TOP_SLAVE_IF_BURST, TOP_SLAVE_IF_BURST_BITWIDTH);
+    m.NewBvInput(TOP_SLAVE_BURST_LEN, TOP_SLAVE_BURST_LEN_BITWIDTH);
+    m.NewBvInput(TOP_SLAVE_BURST_DATA_IN, cfg.vir_mem_burst_bytes * 8);
+  }
+
+  if (cfg.spad_bulk_readback) {
+    m.NewBvInput(TOP_SLAVE_RD_LEN, TOP_SLAVE_RD_LEN_BITWIDTH);
+  }
+
   /////////////////////////////////////////////////////////////////
   // Defining the master interface
   /////////////////////////////////////////////////////////////////
@@ -68,6 +78,9 @@ void DefineTopIO(Ila& m) {
   // this two are output
   m.NewBvState(TOP_MASTER_IF_RD, TOP_MASTER_IF_RD_BITWIDTH);
   m.NewBvState(TOP_MASTER_RD_ADDR_OUT, TOP_MASTER_RD_ADDR_OUT_BITWIDTH);
+  if (cfg.spad_write_back) {
+    m.NewBvState(TOP_MASTER_WR_ADDR_OUT, TOP_MASTER_WR_ADDR_OUT_BITWIDTH);
+  }
 
   // // Top master data in
   // m.NewBvInput(TOP_MASTER_RD_RESP_VALID_FLAG, TOP_MASTER_RD_RESP_VALID_FLAG_BITWIDTH);
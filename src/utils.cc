@@ -71,7 +71,35 @@ ExprRef GetCfgRegAlignedData(const Ila& m) {
   return aligned_data;
 }
 
-void SetConfigRegWrInstr(Ila& m, const int& reg_idx, const std::string& reg_name) {
+ExprRef GetSlaveDataBeat(const Ila& m) {
+  auto data = m.input(TOP_SLAVE_DATA_IN_15);
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_14));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_13));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_12));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_11));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_10));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_9));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_8));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_7));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_6));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_5));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_4));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_3));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_2));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_1));
+  data = Concat(data, m.input(TOP_SLAVE_DATA_IN_0));
+  return data;
+}
+
+ExprRef CfgRegIsConfigAddr(const ExprRef& masked_addr, const bool& wide_write) {
+  if (!wide_write) {
+    return (masked_addr < SPAD0_BASE_ADDR);
+  }
+  return (masked_addr < CFG_REG_WIDE_BASE_ADDR);
+}
+
+void SetConfigRegWrInstr(Ila& m, const int& reg_idx, const std::string& reg_name,
+                         const bool& wide_write) {
   // define config write instructions
   auto is_write = (m.input(TOP_SLAVE_IF_WR) & ~m.input(TOP_SLAVE_IF_RD));
   // masked address.
@@ -79,7 +107,7 @@ void SetConfigRegWrInstr(Ila& m, const int& reg_idx, const std::string& reg_name
   // offset from the CPU.""
   auto masked_addr = Concat(BvConst(0, 8), 
                             Extract(m.input(TOP_SLAVE_ADDR_IN), 23, 0));
-  auto is_config_addr = (masked_addr < SPAD0_BASE_ADDR);
+  auto is_config_addr = CfgRegIsConfigAddr(masked_addr, wide_write);
 
   // get the aligned data. Reg data is only 32 bit
 
@@ -108,15 +136,19 @@ void SetConfigRegWrInstr(Ila& m, const int& reg_idx, const std::string& reg_name
 
 ExprRef act_gen_get_addr(const Ila& child, const ExprRef& in_row,
                                             const ExprRef& in_col,
-                                            const ExprRef& chan_block_idx) {
+                                            const ExprRef& chan_block_idx,
+                                            const int& chan_block_size_val,
+                                            const int& act_bitwidth) {
 //channel_block_address = base_addr + ((channel_block_idx*input_rows*input_cols*CHANNEL_BLOCK_SIZE) 
 // + in_row*(input_cols*CHANNEL_BLOCK_SIZE) + in_col*CHANNEL_BLOCK_SIZE)*(ACTIVATION_TOT_WIDTH/8);
-  auto base_addr = child.state(CFG_REG_ACCEL_CONV_ACT_BASE_ADDR);
+  // the base latched by the conv trigger, the host may program the next layer
+  // (ModelConfig::conv_cmd_queue_depth) while this one runs
+  auto base_addr = child.state(CONV_ACT_BASE);
   auto in_row_ext = Concat(BvConst(0,32-in_row.bit_width()), in_row);
   auto in_col_ext = Concat(BvConst(0,32-in_col.bit_width()), in_col);
   auto chan_block_ext = Concat(BvConst(0,32-chan_block_idx.bit_width()), chan_block_idx);
 
-  auto chan_block_size = BvConst(CHANNEL_BLOCK_SIZE, 32);
+  auto chan_block_size = BvConst(chan_block_size_val, 32);
   auto act_tot_width = BvConst(ACT_TOTAL_BITWIDTH, 32);
 
   auto input_rows_ext = Concat(BvConst(0, 32-CONV_INPUT_ROW_NUM_BITWIDTH),
@@ -127,7 +159,7 @@ ExprRef act_gen_get_addr(const Ila& child, const ExprRef& in_row,
   auto act_addr = base_addr + 
                   ((chan_block_ext * input_rows_ext * input_cols_ext * chan_block_size) +
                     in_row_ext * (input_cols_ext * chan_block_size) +
-                    in_col_ext * chan_block_size) * (ACT_TOTAL_BITWIDTH/8);
+                    in_col_ext * chan_block_size) * (act_bitwidth/8);
   
   return act_addr;
 }
@@ -180,10 +212,57 @@ ExprRef conv_out_of_bound(const Ila& child, const ExprRef& input_row,
   return is_out_of_bound;
 }
 
+ConvKernelWindow conv_kernel_window(const ExprRef& input_idx,
+                                    const ExprRef& kernel_size,
+                                    const ExprRef& input_size,
+                                    const ExprRef& stride)
+{
+  // kernel indices visited by the weight fetching loop for one input index are
+  // k = init, init + stride, ... with init = input_idx % stride, and k is kept
+  // if it is within the kernel and conv_out_of_bound(input_idx, k) is false:
+  //   0 <= input_idx + kernel_size/2 - k < input_size
+  auto ext_bitwidth = input_idx.bit_width();
+
+  auto kernel_size_ext = Concat(BvConst(0, ext_bitwidth-kernel_size.bit_width()), kernel_size);
+  auto input_size_ext = Concat(BvConst(0, ext_bitwidth-input_size.bit_width()), input_size);
+  auto stride_ext = Concat(BvConst(0, ext_bitwidth-stride.bit_width()), stride);
+
+  auto init = URem(input_idx, stride_ext);
+  auto reach = input_idx + kernel_size_ext / BvConst(2, ext_bitwidth);
+
+  auto lo_raw = Ite(reach + 1 > input_size_ext, reach + 1 - input_size_ext,
+                    BvConst(0, ext_bitwidth));
+  auto hi_raw = Ite(reach < kernel_size_ext - 1, reach, kernel_size_ext - 1);
+
+  // align the bounds to the indices with the same remainder as init
+  auto lo_base = Ite(lo_raw > init, lo_raw, init);
+  auto first = init + ((lo_base - init + stride_ext - 1) / stride_ext) * stride_ext;
+  auto last = Ite(hi_raw < init, hi_raw, init + ((hi_raw - init) / stride_ext) * stride_ext);
+
+  auto is_empty = (kernel_size_ext == 0) | (hi_raw < init) | (first > last);
+
+  return {first, last, is_empty};
+}
+
+ExprRef ConvWeightCacheAddr(const Ila& child) {
+  // entry of the current kernel position: k_row*kernel_cols + k_col
+  auto addr_bw = CONV_CHILD_WEIGHT_CACHE_ADDR_BITWIDTH;
+  auto k_row = child.state(CONV_CHILD_KERNEL_ROW_ID);
+  auto k_col = child.state(CONV_CHILD_KERNEL_COL_ID);
+  auto kernel_cols = child.state(CONV_KERNEL_COL_NUM);
+
+  auto k_row_ext = Concat(BvConst(0, addr_bw-k_row.bit_width()), k_row);
+  auto k_col_ext = Concat(BvConst(0, addr_bw-k_col.bit_width()), k_col);
+  auto kernel_cols_ext = Concat(BvConst(0, addr_bw-kernel_cols.bit_width()), kernel_cols);
+
+  return k_row_ext * kernel_cols_ext + k_col_ext;
+}
+
 ExprRef WtGetAddr(const Ila& child, const ExprRef& filter_id,
                                                const ExprRef& k_row,
                                                const ExprRef& k_col,
-                                               const ExprRef& chan_block)
+                                               const ExprRef& chan_block,
+                                               const int& chan_block_size_val)
 {
   // channel_block_address = base_addr + 
   // ((filter_idx*kernel_rows*kernel_cols*last_channel_block*CHANNEL_BLOCK_SIZE) + 
@@ -193,12 +272,8 @@ ExprRef WtGetAddr(const Ila& child, const ExprRef& filter_id,
   auto base_addr = child.state(CONV_WEIGHT_BASE);
   auto kernel_rows = child.state(CONV_KERNEL_ROW_NUM);
   auto kernel_cols = child.state(CONV_KERNEL_COL_NUM);
-  auto input_channels = child.state(CONV_INPUT_CHAN_NUM);
 
-  auto chan_block_size = BvConst(CHANNEL_BLOCK_SIZE, input_channels.bit_width());
-  auto last_chan_block = 
-    Ite(URem(input_channels, chan_block_size) == 0,
-        input_channels / chan_block_size, input_channels / chan_block_size + 1);
+  auto last_chan_block = ConvLastChanBlock(child, chan_block_size_val);
 
   auto filter_id_ext = Concat(BvConst(0, 32-filter_id.bit_width()), filter_id);
   auto k_row_ext = Concat(BvConst(0, 32-k_row.bit_width()), k_row);
@@ -212,10 +287,10 @@ ExprRef WtGetAddr(const Ila& child, const ExprRef& filter_id,
 
   // update 08242020: no need to add the base address for ILA mem access.
   auto addr = (
-    (filter_id_ext * kernel_rows_ext * kernel_cols_ext * last_chan_block_ext * CHANNEL_BLOCK_SIZE) +
-    (chan_block_ext * kernel_rows_ext * kernel_cols_ext * CHANNEL_BLOCK_SIZE) +
-    k_row_ext * (kernel_cols_ext * CHANNEL_BLOCK_SIZE) +
-    k_col_ext * CHANNEL_BLOCK_SIZE
+    (filter_id_ext * kernel_rows_ext * kernel_cols_ext * last_chan_block_ext * chan_block_size_val) +
+    (chan_block_ext * kernel_rows_ext * kernel_cols_ext * chan_block_size_val) +
+    k_row_ext * (kernel_cols_ext * chan_block_size_val) +
+    k_col_ext * chan_block_size_val
     ) * (WEIGHT_TOTAL_BITWIDTH/8) / BvConst(NIC_MEM_ELEM_BYTEWIDTH, 32);
   
   return addr;
@@ -225,7 +300,9 @@ ExprRef OutActGetAddr(const Ila& child, const ExprRef& input_row,
                                         const ExprRef& input_col,
                                         const ExprRef& k_row,
                                         const ExprRef& k_col,
-                                        const ExprRef& filter_idx)
+                                        const ExprRef& filter_idx,
+                                        const int& chan_block_size_val,
+                                        const int& act_bitwidth)
 {
   auto last_kernel_row = child.state(CONV_KERNEL_ROW_NUM);
   auto last_kernel_col = child.state(CONV_KERNEL_COL_NUM);
@@ -254,10 +331,10 @@ ExprRef OutActGetAddr(const Ila& child, const ExprRef& input_row,
 
   auto out_act_addr = 
         (
-          (filter_idx_ext * last_row_ext * last_col_ext * CHANNEL_BLOCK_SIZE) +
-          out_row * (last_col_ext * CHANNEL_BLOCK_SIZE) +
-          out_col * CHANNEL_BLOCK_SIZE
-        ) * (ACT_TOTAL_BITWIDTH/8) / BvConst(NIC_MEM_ELEM_BYTEWIDTH, ext_bitwidth);
+          (filter_idx_ext * last_row_ext * last_col_ext * chan_block_size_val) +
+          out_row * (last_col_ext * chan_block_size_val) +
+          out_col * chan_block_size_val
+        ) * (act_bitwidth/8) / BvConst(NIC_MEM_ELEM_BYTEWIDTH, ext_bitwidth);
 
   return out_act_addr;
 }
@@ -266,15 +343,12 @@ ExprRef WtIsLastPsum(const Ila& child, const ExprRef& act_row,
                                        const ExprRef& act_col,
                                        const ExprRef& k_row,
                                        const ExprRef& k_col,
-                                       const ExprRef& chan_block)
+                                       const ExprRef& chan_block,
+                                       const int& chan_block_size_val)
 {
   auto last_kernel_row = child.state(CONV_KERNEL_ROW_NUM);
   auto last_kernel_col = child.state(CONV_KERNEL_COL_NUM);
-  auto input_channels = child.state(CONV_INPUT_CHAN_NUM);
-  auto chan_block_size = BvConst(CHANNEL_BLOCK_SIZE, input_channels.bit_width());
-  auto last_chan_block = 
-    Ite(URem(input_channels, chan_block_size) == 0,
-        input_channels / chan_block_size, input_channels / chan_block_size + 1);
+  auto last_chan_block = ConvLastChanBlock(child, chan_block_size_val);
   
   auto last_kernel_row_ext = Concat(BvConst(0, k_row.bit_width()-last_kernel_row.bit_width()),
                                     last_kernel_row);
@@ -290,5 +364,302 @@ ExprRef WtIsLastPsum(const Ila& child, const ExprRef& act_row,
   return is_last_psum;
 }
 
+// the grouped conv helpers compute in the channel block id bitwidth, which
+// holds any channel count
+static ExprRef ConvGroupExt(const ExprRef& val)
+{
+  return Concat(BvConst(0, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH-val.bit_width()), val);
+}
+
+ExprRef ConvGroupChans(const Ila& child)
+{
+  auto input_channels = ConvGroupExt(child.state(CONV_INPUT_CHAN_NUM));
+  auto group_num_log2 = ConvGroupExt(child.state(CONV_GROUP_NUM_LOG2));
+  return Lshr(input_channels, group_num_log2);
+}
+
+ExprRef ConvIsGrouped(const Ila& child, const int& chan_block_size_val)
+{
+  // the channels and the filters must split evenly over the groups, and the
+  // channels of a group must be whole channel blocks or fit evenly in one
+  auto group_num_log2 = ConvGroupExt(child.state(CONV_GROUP_NUM_LOG2));
+  auto input_channels = ConvGroupExt(child.state(CONV_INPUT_CHAN_NUM));
+  auto num_filters = ConvGroupExt(child.state(CONV_OFILTER_IDX));
+  auto group_chans = ConvGroupChans(child);
+  auto group_filters = Lshr(num_filters, group_num_log2);
+  auto chan_block_size = BvConst(chan_block_size_val, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+
+  auto is_chan_split = (group_chans != 0) & ((group_chans << group_num_log2) == input_channels);
+  auto is_filter_split = (group_filters != 0) & ((group_filters << group_num_log2) == num_filters);
+  auto is_block_aligned = 
+    Ite(group_chans >= chan_block_size,
+        URem(group_chans, chan_block_size) == 0,
+        URem(chan_block_size, group_chans) == 0);
+
+  return (group_num_log2 != 0) & is_chan_split & is_filter_split & is_block_aligned;
+}
+
+// group of filter_idx in a grouped layer
+static ExprRef ConvFilterGroup(const Ila& child, const ExprRef& filter_idx)
+{
+  auto group_num_log2 = ConvGroupExt(child.state(CONV_GROUP_NUM_LOG2));
+  auto num_filters = ConvGroupExt(child.state(CONV_OFILTER_IDX));
+  return ConvGroupExt(filter_idx) / Lshr(num_filters, group_num_log2);
+}
+
+ExprRef ConvFilterChanBlocks(const Ila& child, const int& chan_block_size_val)
+{
+  auto last_chan_block = ConvGroupExt(ConvLastChanBlock(child, chan_block_size_val));
+  auto group_chans = ConvGroupChans(child);
+  auto chan_block_size = BvConst(chan_block_size_val, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+
+  auto group_blocks = Ite(group_chans >= chan_block_size, group_chans / chan_block_size,
+                          BvConst(1, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH));
+  return Ite(ConvIsGrouped(child, chan_block_size_val), group_blocks, last_chan_block);
+}
+
+ExprRef ConvFilterFirstChanBlock(const Ila& child, const ExprRef& filter_idx,
+                                 const int& chan_block_size_val)
+{
+  auto group_chans = ConvGroupChans(child);
+  auto chan_block_size = BvConst(chan_block_size_val, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+  auto first_chan = ConvFilterGroup(child, filter_idx) * group_chans;
+
+  return Ite(ConvIsGrouped(child, chan_block_size_val),
+             first_chan / chan_block_size, BvConst(0, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH));
+}
+
+ExprRef ConvFilterLanes(const Ila& child, const int& chan_block_size_val)
+{
+  auto group_chans = ConvGroupChans(child);
+  auto chan_block_size = BvConst(chan_block_size_val, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+
+  return Ite(ConvIsGrouped(child, chan_block_size_val) & (group_chans < chan_block_size),
+             group_chans, chan_block_size);
+}
+
+ExprRef ConvFilterFirstLane(const Ila& child, const ExprRef& filter_idx,
+                            const int& chan_block_size_val)
+{
+  auto group_chans = ConvGroupChans(child);
+  auto chan_block_size = BvConst(chan_block_size_val, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH);
+  auto first_chan = ConvFilterGroup(child, filter_idx) * group_chans;
+
+  return Ite(ConvIsGrouped(child, chan_block_size_val) & (group_chans < chan_block_size),
+             URem(first_chan, chan_block_size), BvConst(0, CONV_CHILD_CHAN_BLOCK_ID_BITWIDTH));
+}
+
+ExprRef ConvGroupedWtAddr(const Ila& child, const ExprRef& filter_id,
+                                            const ExprRef& k_row,
+                                            const ExprRef& k_col,
+                                            const ExprRef& chan_block,
+                                            const int& chan_block_size_val,
+                                            const bool& ping_pong)
+{
+  // each filter holds filter_blocks blocks of filter_lanes weights per kernel
+  // position, i.e. only the channels of its group:
+  // ((filter_idx*filter_blocks + group_chan_block)*kernel_rows*kernel_cols +
+  //  k_row*kernel_cols + k_col) * filter_lanes
+  // this equals WtGetAddr*(NIC_MEM_ELEM_BYTEWIDTH/2) for an ungrouped layer
+  auto kernel_rows = child.state(CONV_KERNEL_ROW_NUM);
+  auto kernel_cols = child.state(CONV_KERNEL_COL_NUM);
+  auto filter_blocks = ConvFilterChanBlocks(child, chan_block_size_val);
+  auto filter_lanes = ConvFilterLanes(child, chan_block_size_val);
+  auto group_chan_block = 
+    chan_block - ConvFilterFirstChanBlock(child, filter_id, chan_block_size_val);
+
+  auto filter_id_ext = Concat(BvConst(0, 32-filter_id.bit_width()), filter_id);
+  auto k_row_ext = Concat(BvConst(0, 32-k_row.bit_width()), k_row);
+  auto k_col_ext = Concat(BvConst(0, 32-k_col.bit_width()), k_col);
+  auto chan_block_ext = Concat(BvConst(0, 32-group_chan_block.bit_width()), group_chan_block);
+  auto kernel_rows_ext = Concat(BvConst(0, 32-kernel_rows.bit_width()), kernel_rows);
+  auto kernel_cols_ext = Concat(BvConst(0, 32-kernel_cols.bit_width()), kernel_cols);
+  auto filter_blocks_ext = Concat(BvConst(0, 32-filter_blocks.bit_width()), filter_blocks);
+  auto filter_lanes_ext = Concat(BvConst(0, 32-filter_lanes.bit_width()), filter_lanes);
+
+  auto addr = (
+    (filter_id_ext * filter_blocks_ext + chan_block_ext) * kernel_rows_ext * kernel_cols_ext +
+    k_row_ext * kernel_cols_ext + k_col_ext
+    ) * filter_lanes_ext;
+
+  return ConvWtSpad0Base(child, ping_pong) + addr;
+}
+
+ExprRef ConvLastFilterGroup(const Ila& child, const int& group_size_val)
+{
+  // last_filter_group = frac_ceil(num_filters, group_size);
+  auto num_filters = child.state(CONV_OFILTER_IDX);
+  auto group_size = BvConst(group_size_val, num_filters.bit_width());
+  auto last_filter_group = 
+    Ite(URem(num_filters, group_size) == 0,
+        num_filters / group_size, num_filters / group_size + 1);
+  return last_filter_group;
+}
+
+ExprRef ConvLastChanBlock(const Ila& child, const int& chan_block_size_val)
+{
+  // last_channel_block = frac_ceil(input_channels, channel_block_size);
+  auto input_channels = child.state(CONV_INPUT_CHAN_NUM);
+  auto chan_block_size = BvConst(chan_block_size_val, input_channels.bit_width());
+  auto last_chan_block = 
+    Ite(URem(input_channels, chan_block_size) == 0,
+        input_channels / chan_block_size, input_channels / chan_block_size + 1);
+  return last_chan_block;
+}
+
+std::vector<ExprRef> MemLoadBytes(const ExprRef& mem, const ExprRef& addr, const int& num)
+{
+  std::vector<ExprRef> bytes;
+  if (!MemIsWordLevel(mem)) {
+    for (auto i = 0; i < num; i++) {
+      bytes.push_back(Load(mem, addr + i));
+    }
+    return bytes;
+  }
+  // shift the byte at addr down to the low bits of its word, more than one
+  // word is only read from a word-aligned addr
+  auto word_bitwidth = mem.data_width();
+  auto offset = Concat(BvConst(0, word_bitwidth - 4), Extract(addr, 3, 0));
+  for (auto w = 0; w * NIC_MEM_ELEM_BYTEWIDTH < num; w++) {
+    auto word = Lshr(Load(mem, Lshr(addr, 4) + w), offset * 8);
+    for (auto i = 0; (i < NIC_MEM_ELEM_BYTEWIDTH) && (w * NIC_MEM_ELEM_BYTEWIDTH + i < num); i++) {
+      bytes.push_back(Extract(word, 8*i + 7, 8*i));
+    }
+  }
+  return bytes;
+}
+
+std::vector<ExprRef> MemLoadActVector(const ExprRef& mem, const ExprRef& addr, const int& num,
+                                      const int& act_bitwidth)
+{
+  auto elem_bytes = act_bitwidth/8;
+  std::vector<ExprRef> acts;
+  if (!MemIsWordLevel(mem)) {
+    for (auto i = 0; i < num; i++) {
+      auto elem = Load(mem, addr + elem_bytes*i);
+      for (auto b = 1; b < elem_bytes; b++) {
+        elem = Concat(Load(mem, addr + elem_bytes*i + b), elem);
+      }
+      acts.push_back(elem);
+    }
+    return acts;
+  }
+  auto elems_per_word = NIC_MEM_ELEM_BYTEWIDTH / elem_bytes;
+  for (auto w = 0; w * elems_per_word < num; w++) {
+    auto word = Load(mem, Lshr(addr, 4) + w);
+    for (auto i = 0; (i < elems_per_word) && (w * elems_per_word + i < num); i++) {
+      acts.push_back(Extract(word, act_bitwidth*(i+1) - 1, act_bitwidth*i));
+    }
+  }
+  return acts;
+}
+
+ExprRef MemStoreActVector(const ExprRef& mem, const ExprRef& addr,
+                          const std::vector<ExprRef>& acts)
+{
+  auto num = static_cast<int>(acts.size());
+  auto elem_bytes = (num > 0) ? acts[0].bit_width()/8 : 1;
+  auto mem_next = mem;
+  if (!MemIsWordLevel(mem)) {
+    for (auto i = 0; i < num; i++) {
+      for (auto b = 0; b < elem_bytes; b++) {
+        mem_next = Store(mem_next, addr + elem_bytes*i + b, Extract(acts[i], 8*b + 7, 8*b));
+      }
+    }
+    return mem_next;
+  }
+  // only whole words are written
+  auto elems_per_word = NIC_MEM_ELEM_BYTEWIDTH / elem_bytes;
+  ILA_ASSERT(num % elems_per_word == 0) << "partial word store of " << num << " elements";
+  for (auto w = 0; w * elems_per_word < num; w++) {
+    auto word = acts[w * elems_per_word];
+    for (auto i = 1; i < elems_per_word; i++) {
+      word = Concat(acts[w * elems_per_word + i], word);
+    }
+    mem_next = Store(mem_next, Lshr(addr, 4) + w, word);
+  }
+  return mem_next;
+}
+
+ExprRef MemLoadWord(const ExprRef& mem, const ExprRef& addr)
+{
+  if (MemIsWordLevel(mem)) {
+    return Load(mem, Lshr(addr, 4));
+  }
+  auto word = Load(mem, addr);
+  for (auto i = 1; i < NIC_MEM_ELEM_BYTEWIDTH; i++) {
+    word = Concat(Load(mem, addr + i), word);
+  }
+  return word;
+}
+
+ExprRef MemStoreWord(const ExprRef& mem, const ExprRef& addr, const ExprRef& data)
+{
+  if (MemIsWordLevel(mem)) {
+    return Store(mem, Lshr(addr, 4), data);
+  }
+  auto mem_next = mem;
+  for (auto i = 0; i < NIC_MEM_ELEM_BYTEWIDTH; i++) {
+    mem_next = Store(mem_next, addr + i, Extract(data, 8*i + 7, 8*i));
+  }
+  return mem_next;
+}
+
+ExprRef ConvOutSpad1Base(const Ila& child, const bool& ping_pong)
+{
+  if (!ping_pong) {
+    return BvConst(0, CONV_SPAD_OUTPUT_BASE_BITWIDTH);
+  }
+  return child.state(CONV_SPAD_OUTPUT_BASE);
+}
+
+ExprRef ConvWtSpad0Base(const Ila& child, const bool& ping_pong)
+{
+  if (!ping_pong) {
+    return BvConst(0, CONV_WEIGHT_BASE_BITWIDTH);
+  }
+  return child.state(CONV_WEIGHT_BASE);
+}
+
+ExprRef SpadIsConvOwned(const Ila& m, const int& spad_idx, const ExprRef& spad_addr,
+                        const bool& act_spad1)
+{
+  auto conv_half = m.state((spad_idx == 0) ? SPAD0_CONV_HALF : SPAD1_CONV_HALF);
+  auto addr_half = Ite(spad_addr >= SPAD_HALF_BYTE_NUM,
+                       BvConst(1, SPAD_CONV_HALF_BITWIDTH), BvConst(0, SPAD_CONV_HALF_BITWIDTH));
+  auto is_conv_running = (m.state(ACCEL_CONV_CHILD_VALID_FLAG) == ACCEL_CONV_CHILD_VALID);
+  auto is_owned = (addr_half == conv_half);
+  if (act_spad1 && (spad_idx == 1)) {
+    auto is_act_owned = (m.state(CONV_ACT_SRC_SPAD1) == 1) &
+                        (addr_half == m.state(SPAD1_CONV_ACT_HALF));
+    is_owned = is_owned | is_act_owned;
+  }
+  return is_conv_running & is_owned;
+}
+
+std::vector<ExprRef> ConvLoadActVector(const Ila& child, const ExprRef& addr, const int& num,
+                                       const bool& spad1_src, const int& act_bitwidth)
+{
+  auto acts = MemLoadActVector(child.state(VIRTUAL_SOC_MEMORY), addr, num, act_bitwidth);
+  if (!spad1_src) {
+    return acts;
+  }
+  auto spad1_acts = MemLoadActVector(child.state(SCRATCH_PAD_1), addr, num, act_bitwidth);
+  auto is_spad1 = (child.state(CONV_ACT_SRC_SPAD1) == 1);
+  for (auto i = 0; i < num; i++) {
+    acts[i] = Ite(is_spad1, spad1_acts[i], acts[i]);
+  }
+  return acts;
+}
+
+ExprRef ConvCoarseKernelFit(const Ila& child)
+{
+  // the coarse-grained conv child unrolls the kernel loops up to a fixed size
+  auto kernel_rows = child.state(CONV_KERNEL_ROW_NUM);
+  auto kernel_cols = child.state(CONV_KERNEL_COL_NUM);
+  auto max_size = BvConst(CONV_COARSE_MAX_KERNEL_SIZE, kernel_rows.bit_width());
+  return (kernel_rows <= max_size) & (kernel_cols <= max_size);
+}
+
 } // namespace hlscnn
 } // namespace ilang
\ No newline at end of file
@@ -32,37 +32,70 @@
 namespace ilang {
 namespace hlscnn {
 
-void DefineVirMemInstr(Ila& m) {
+void DefineVirMemInstr(Ila& m, const ModelConfig& cfg) {
+
+  auto is_write = (m.input(TOP_SLAVE_IF_WR) & ~m.input(TOP_SLAVE_IF_RD));
+  auto addr_valid = ((m.input(TOP_SLAVE_ADDR_IN) >= VIRTUAL_SOC_MEMORY_ADDR_MIN) &
+                      (m.input(TOP_SLAVE_ADDR_IN) < VIRTUAL_SOC_MEMORY_ADDR_MAX));
+  // single-beat writes are the ones without the burst flag
+  auto is_beat_write = (cfg.vir_mem_burst_bytes > 0) ?
+    is_write & (m.input(TOP_SLAVE_IF_BURST) == 0) : is_write;
 
   { // write data into virtual memory
     auto instr = m.NewInstr("VIR_MEM_WR");
     
-    auto is_write = (m.input(TOP_SLAVE_IF_WR) & ~m.input(TOP_SLAVE_IF_RD));
-    auto addr_valid = ((m.input(TOP_SLAVE_ADDR_IN) >= VIRTUAL_SOC_MEMORY_ADDR_MIN) &
-                        (m.input(TOP_SLAVE_ADDR_IN) < VIRTUAL_SOC_MEMORY_ADDR_MAX));
-    instr.SetDecode(is_write & addr_valid);
+    instr.SetDecode(is_beat_write & addr_valid);
+
+    auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+    auto vir_mem_next = vir_mem;
+
+    auto addr = m.input(TOP_SLAVE_ADDR_IN) - VIRTUAL_SOC_MEMORY_ADDR_MIN;
+
+    if (MemIsWordLevel(vir_mem)) {
+      // the 16 data bytes make one word, byte 0 in the low bits
+      auto data = GetSlaveDataBeat(m);
+      vir_mem_next = MemStoreWord(vir_mem, addr, data);
+    } else {
+      vir_mem_next = Store(vir_mem_next, addr + 0, m.input(TOP_SLAVE_DATA_IN_0));
+      vir_mem_next = Store(vir_mem_next, addr + 1, m.input(TOP_SLAVE_DATA_IN_1));
+      vir_mem_next = Store(vir_mem_next, addr + 2, m.input(TOP_SLAVE_DATA_IN_2));
+      vir_mem_next = Store(vir_mem_next, addr + 3, m.input(TOP_SLAVE_DATA_IN_3));
+      vir_mem_next = Store(vir_mem_next, addr + 4, m.input(TOP_SLAVE_DATA_IN_4));
+      vir_mem_next = Store(vir_mem_next, addr + 5, m.input(TOP_SLAVE_DATA_IN_5));
+      vir_mem_next = Store(vir_mem_next, addr + 6, m.input(TOP_SLAVE_DATA_IN_6));
+      vir_mem_next = Store(vir_mem_next, addr + 7, m.input(TOP_SLAVE_DATA_IN_7));
+      vir_mem_next = Store(vir_mem_next, addr + 8, m.input(TOP_SLAVE_DATA_IN_8));
+      vir_mem_next = Store(vir_mem_next, addr + 9, m.input(TOP_SLAVE_DATA_IN_9));
+      vir_mem_next = Store(vir_mem_next, addr + 10, m.input(TOP_SLAVE_DATA_IN_10));
+      vir_mem_next = Store(vir_mem_next, addr + 11, m.input(TOP_SLAVE_DATA_IN_11));
+      vir_mem_next = Store(vir_mem_next, addr + 12, m.input(TOP_SLAVE_DATA_IN_12));
+      vir_mem_next = Store(vir_mem_next, addr + 13, m.input(TOP_SLAVE_DATA_IN_13));
+      vir_mem_next = Store(vir_mem_next, addr + 14, m.input(TOP_SLAVE_DATA_IN_14));
+      vir_mem_next = Store(vir_mem_next, addr + 15, m.input(TOP_SLAVE_DATA_IN_15));
+    }
+
+    instr.SetUpdate(vir_mem, vir_mem_next);
+  }
+
+  if (cfg.vir_mem_burst_bytes > 0) { // burst write into virtual memory
+    auto instr = m.NewInstr("VIR_MEM_BURST_WR");
+    instr.SetDecode(is_write & (m.input(TOP_SLAVE_IF_BURST) == 1) & addr_valid);
 
     auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
     auto vir_mem_next = vir_mem;
 
     auto addr = m.input(TOP_SLAVE_ADDR_IN) - VIRTUAL_SOC_MEMORY_ADDR_MIN;
+    auto burst_len = m.input(TOP_SLAVE_BURST_LEN);
+    auto burst_data = m.input(TOP_SLAVE_BURST_DATA_IN);
 
-    vir_mem_next = Store(vir_mem_next, addr + 0, m.input(TOP_SLAVE_DATA_IN_0));
-    vir_mem_next = Store(vir_mem_next, addr + 1, m.input(TOP_SLAVE_DATA_IN_1));
-    vir_mem_next = Store(vir_mem_next, addr + 2, m.input(TOP_SLAVE_DATA_IN_2));
-    vir_mem_next = Store(vir_mem_next, addr + 3, m.input(TOP_SLAVE_DATA_IN_3));
-    vir_mem_next = Store(vir_mem_next, addr + 4, m.input(TOP_SLAVE_DATA_IN_4));
-    vir_mem_next = Store(vir_mem_next, addr + 5, m.input(TOP_SLAVE_DATA_IN_5));
-    vir_mem_next = Store(vir_mem_next, addr + 6, m.input(TOP_SLAVE_DATA_IN_6));
-    vir_mem_next = Store(vir_mem_next, addr + 7, m.input(TOP_SLAVE_DATA_IN_7));
-    vir_mem_next = Store(vir_mem_next, addr + 8, m.input(TOP_SLAVE_DATA_IN_8));
-    vir_mem_next = Store(vir_mem_next, addr + 9, m.input(TOP_SLAVE_DATA_IN_9));
-    vir_mem_next = Store(vir_mem_next, addr + 10, m.input(TOP_SLAVE_DATA_IN_10));
-    vir_mem_next = Store(vir_mem_next, addr + 11, m.input(TOP_SLAVE_DATA_IN_11));
-    vir_mem_next = Store(vir_mem_next, addr + 12, m.input(TOP_SLAVE_DATA_IN_12));
-    vir_mem_next = Store(vir_mem_next, addr + 13, m.input(TOP_SLAVE_DATA_IN_13));
-    vir_mem_next = Store(vir_mem_next, addr + 14, m.input(TOP_SLAVE_DATA_IN_14));
-    vir_mem_next = Store(vir_mem_next, addr + 15, m.input(TOP_SLAVE_DATA_IN_15));
+    // the beats past burst_len keep the old data
+    auto beat_bits = NIC_MEM_ELEM_BYTEWIDTH * 8;
+    for (auto b = 0; b < cfg.vir_mem_burst_bytes / NIC_MEM_ELEM_BYTEWIDTH; b++) {
+      auto beat_addr = addr + b * NIC_MEM_ELEM_BYTEWIDTH;
+      auto beat_data = Extract(burst_data, beat_bits*(b+1) - 1, beat_bits*b);
+      auto beat_old = MemLoadWord(vir_mem, beat_addr);
+      vir_mem_next = MemStoreWord(vir_mem_next, beat_addr, Ite(burst_len > b, beat_data, beat_old));
+    }
 
     instr.SetUpdate(vir_mem, vir_mem_next);
   }
@@ -0,0 +1,141 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: axi_master_test.cc
+
+// Checks the AXI master child through the Z3 unroller with 2 outstanding
+// reads and a latency of 1: the SPAD child requests two beats back to back,
+// their responses are written into spad0 in order once the latency has
+// passed, and a response is not written before that.
+
+#include "test_util.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+#define TEST_SPAD_OFFSET 0x100
+#define TEST_SOC_ADDR 0x200
+#define TEST_LINE_BYTES 16
+
+// constrain a bitvector state of the model at the start of the path
+static void SetInitVal(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                       const std::string& name, const int& val) {
+  auto s = m.state(name);
+  solver.add(unroller.CurrState(s, 0) == solver.ctx().bv_val(val, s.bit_width()));
+}
+
+// byte at addr of mem after step t
+static z3::expr MemByte(IlaZ3Unroller& unroller, const ExprRef& mem, const int& t,
+                        const int& addr) {
+  auto mem_t = unroller.CurrState(mem, t);
+  return z3::select(mem_t, mem_t.ctx().bv_val(addr, TOP_SLAVE_ADDR_IN_BITWIDTH));
+}
+
+// a 2-line SPAD0 fill with no read in flight, the host write addr is held
+// during the path
+static void SetSpadFill(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                        const int& path_len) {
+  SetInitVal(solver, unroller, m, SPAD_CHILD_VALID_FLAG, 1);
+  SetInitVal(solver, unroller, m, SPAD_CHILD_TARGET, 0);
+  SetInitVal(solver, unroller, m, SPAD_RD_WR_CNTR, 0);
+  SetInitVal(solver, unroller, m, SPAD_RD_REQ_CNTR, 0);
+  SetInitVal(solver, unroller, m, CFG_REG_SOC_MEM_BASE_ADDR, TEST_SOC_ADDR);
+  SetInitVal(solver, unroller, m, CFG_REG_SOC_MEM_RD_WR_LENGTH, 2);
+  SetInitVal(solver, unroller, m, AXI_MASTER_RD_HEAD, 0);
+  SetInitVal(solver, unroller, m, AXI_MASTER_RD_TAIL, 0);
+  SetInitVal(solver, unroller, m, AXI_MASTER_RD_CNT, 0);
+
+  auto addr_in = m.input(TOP_SLAVE_ADDR_IN);
+  for (auto t = 0; t < path_len; t++) {
+    solver.add(unroller.CurrState(addr_in, t) ==
+               solver.ctx().bv_val(SPAD0_BASE_ADDR + TEST_SPAD_OFFSET, addr_in.bit_width()));
+  }
+}
+
+bool CheckInOrder(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  auto rd_req = FindInstr(m, "spad_0_child_rd_req");
+  auto wr = FindInstr(m, "spad_0_child_wr");
+  std::vector<InstrRef> path = {rd_req, rd_req, FindInstr(m, "accel_axi_master_rd_tick"),
+                                wr, wr};
+  solver.add(unroller.UnrollPathConn(path));
+  SetSpadFill(solver, unroller, m, (int)path.size());
+
+  auto t_end = (int)path.size();
+  auto spad0 = m.state(SCRATCH_PAD_0);
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+  auto prop = (unroller.CurrState(m.state(SPAD_CHILD_VALID_FLAG), t_end) ==
+               ctx.bv_val(0, SPAD_CHILD_VALID_FLAG_BITWIDTH)) &&
+              (unroller.CurrState(m.state(AXI_MASTER_RD_CNT), t_end) ==
+               ctx.bv_val(0, AXI_MASTER_RD_CNT_BITWIDTH)) &&
+              (unroller.CurrState(m.state(TOP_MASTER_IF_RD), t_end) ==
+               ctx.bv_val(0, TOP_MASTER_IF_RD_BITWIDTH));
+  for (auto i = 0; i < 2 * TEST_LINE_BYTES; i++) {
+    prop = prop && (MemByte(unroller, spad0, t_end, TEST_SPAD_OFFSET + i) ==
+                    MemByte(unroller, vir_mem, 0, TEST_SOC_ADDR + i));
+  }
+
+  return CheckProperty(solver, prop, "in order");
+}
+
+bool CheckLatency(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  // the response is written right after its request, without the tick
+  std::vector<InstrRef> path = {FindInstr(m, "spad_0_child_rd_req"),
+                                FindInstr(m, "spad_0_child_wr")};
+  solver.add(unroller.UnrollPathConn(path));
+  SetSpadFill(solver, unroller, m, (int)path.size());
+
+  if (solver.check() != z3::unsat) {
+    std::cerr << "latency: response written before the latency" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.axi_master_outstanding = 2;
+  cfg.axi_master_latency = 1;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  auto pass = true;
+  pass &= CheckInOrder(m);
+  pass &= CheckLatency(m);
+
+  return pass ? 0 : 1;
+}
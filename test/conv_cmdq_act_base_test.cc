@@ -0,0 +1,87 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: conv_cmdq_act_base_test.cc
+
+// With the conv command queue, the host writes the config registers of the
+// next layer while the current one runs. Checks through the Z3 unroller that
+// rewriting AccelConvActivationBaseAddr changes neither the act fetch addr of
+// the running layer nor the act base of a queued layer when it is launched.
+
+#include "test_util.h"
+
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+// run path_a (with the act base write) and path_b (without it) from the same
+// state, and check that target is the same at the end of both paths
+static bool CheckActBaseIndependent(const Ila& m, const std::vector<InstrRef>& path_a,
+                                    const std::vector<InstrRef>& path_b,
+                                    const ExprRef& target,
+                                    const std::string& test_name) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller_a(ctx, "_a");
+  IlaZ3Unroller unroller_b(ctx, "_b");
+
+  solver.add(unroller_a.UnrollPathConn(path_a));
+  solver.add(unroller_b.UnrollPathConn(path_b));
+
+  std::vector<ExprRef> states;
+  CollectStates(m, states);
+  for (auto& s : states) {
+    solver.add(unroller_a.CurrState(s, 0) == unroller_b.CurrState(s, 0));
+  }
+
+  return CheckProperty(solver,
+                       unroller_a.CurrState(target, (int)path_a.size()) ==
+                       unroller_b.CurrState(target, (int)path_b.size()),
+                       test_name);
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.conv_cmd_queue_depth = 2;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  auto wr_act_base = FindInstr(m, std::string("CFG_WR_") + CFG_REG_ACCEL_CONV_ACT_BASE_ADDR);
+  auto act_fetch = FindInstr(m, "accel_conv_child_act_fetch_activations");
+  auto cmdq_launch = FindInstr(m, "accel_conv_cmdq_launch");
+
+  auto pass = true;
+  // the running layer keeps fetching from its own act base
+  pass &= CheckActBaseIndependent(m, {wr_act_base, act_fetch}, {act_fetch},
+                                  m.state(TOP_MASTER_RD_ADDR_OUT), "running layer");
+  // a queued layer starts with the act base of its queue entry
+  pass &= CheckActBaseIndependent(m, {wr_act_base, cmdq_launch}, {cmdq_launch},
+                                  m.state(CONV_ACT_BASE), "queued layer");
+
+  return pass ? 0 : 1;
+}
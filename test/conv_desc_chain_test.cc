@@ -0,0 +1,139 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: conv_desc_chain_test.cc
+
+// Checks a chain of two conv layer descriptors through the Z3 unroller: each
+// descriptor copies its weights into spad0 through the SPAD child before its
+// layer is launched with its act base, and the chain stops after the second
+// one. The layers are computed by the ConvLayer trigger path
+// (ModelConfig::conv_layer_uf), so the conv child is idle between them.
+
+#include "test_util.h"
+
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+#define TEST_DESC0_ADDR 0x1000
+#define TEST_DESC1_ADDR 0x1040
+#define TEST_WT0_ADDR 0x2000
+#define TEST_WT1_ADDR 0x2100
+#define TEST_ACT0_BASE 0x0
+#define TEST_ACT1_BASE 0x80
+#define TEST_LINE_BYTES 16
+
+// constrain a bitvector state of the model at the start of the path
+static void SetInitVal(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                       const std::string& name, const int& val) {
+  auto s = m.state(name);
+  solver.add(unroller.CurrState(s, 0) == solver.ctx().bv_val(val, s.bit_width()));
+}
+
+// byte at addr of mem after step t
+static z3::expr MemByte(IlaZ3Unroller& unroller, const ExprRef& mem, const int& t,
+                        const int& addr) {
+  auto mem_t = unroller.CurrState(mem, t);
+  return z3::select(mem_t, mem_t.ctx().bv_val(addr, TOP_SLAVE_ADDR_IN_BITWIDTH));
+}
+
+// constrain the 32-bit descriptor field at addr (byte 0 in the low bits)
+static void SetDescField(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                         const int& addr, const unsigned& val) {
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+  for (auto i = 0; i < 4; i++) {
+    solver.add(MemByte(unroller, vir_mem, 0, addr + i) ==
+               solver.ctx().bv_val((val >> (8*i)) & 0xff, VIRTUAL_SOC_MEMORY_DATA_BITWIDTH));
+  }
+}
+
+static void SetDesc(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                    const int& desc_addr, const int& act_base, const int& next_desc_addr,
+                    const int& wt_addr) {
+  SetDescField(solver, unroller, m, desc_addr, act_base);
+  SetDescField(solver, unroller, m, desc_addr + 28, next_desc_addr);
+  SetDescField(solver, unroller, m, desc_addr + 32, wt_addr);
+  SetDescField(solver, unroller, m, desc_addr + 36, 1);
+}
+
+// whether spad0 holds the weight line at wt_addr after step t
+static z3::expr IsWtLoaded(IlaZ3Unroller& unroller, const Ila& m, const int& t,
+                           const int& wt_addr) {
+  auto spad0 = m.state(SCRATCH_PAD_0);
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+  auto res = (MemByte(unroller, spad0, t, 0) == MemByte(unroller, vir_mem, 0, wt_addr));
+  for (auto i = 1; i < TEST_LINE_BYTES; i++) {
+    res = res && (MemByte(unroller, spad0, t, i) == MemByte(unroller, vir_mem, 0, wt_addr + i));
+  }
+  return res;
+}
+
+bool CheckTwoLayers(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  auto wt_dma = FindInstr(m, "accel_conv_desc_wt_dma");
+  auto spad_wr = FindInstr(m, "spad_0_child_wr");
+  auto launch = FindInstr(m, "accel_conv_desc_launch");
+  std::vector<InstrRef> path = {FindInstr(m, "CFG_REG_WR_ACCEL_CONV_DESC_ADDR"),
+                                wt_dma, spad_wr, launch,
+                                wt_dma, spad_wr, launch};
+  solver.add(unroller.UnrollPathConn(path));
+
+  SetInitVal(solver, unroller, m, SPAD_CHILD_VALID_FLAG, 0);
+  SetInitVal(solver, unroller, m, ACCEL_CONV_CHILD_VALID_FLAG, ACCEL_CONV_CHILD_INVALID);
+  solver.add(unroller.CurrState(m.state(CONV_DESC_ADDR), 1) ==
+             ctx.bv_val(TEST_DESC0_ADDR, CONV_DESC_ADDR_BITWIDTH));
+  SetDesc(solver, unroller, m, TEST_DESC0_ADDR, TEST_ACT0_BASE, TEST_DESC1_ADDR, TEST_WT0_ADDR);
+  SetDesc(solver, unroller, m, TEST_DESC1_ADDR, TEST_ACT1_BASE, 0, TEST_WT1_ADDR);
+
+  auto act_base = m.state(CONV_ACT_BASE);
+  auto act0_base = ctx.bv_val(TEST_ACT0_BASE, act_base.bit_width());
+  auto act1_base = ctx.bv_val(TEST_ACT1_BASE, act_base.bit_width());
+  auto t_end = (int)path.size();
+  // the weights of a layer are in spad0 before it is launched
+  auto prop = IsWtLoaded(unroller, m, 3, TEST_WT0_ADDR) &&
+              (unroller.CurrState(act_base, 4) == act0_base) &&
+              IsWtLoaded(unroller, m, 6, TEST_WT1_ADDR) &&
+              (unroller.CurrState(act_base, t_end) == act1_base) &&
+              (unroller.CurrState(m.state(CONV_DESC_CHILD_VALID_FLAG), t_end) ==
+               ctx.bv_val(0, CONV_DESC_CHILD_VALID_FLAG_BITWIDTH));
+
+  return CheckProperty(solver, prop, "two layers");
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.conv_desc_chain = true;
+  cfg.conv_layer_uf = true;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  return CheckTwoLayers(m) ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: fc_child_test.cc
+
+// Checks the FC child through the Z3 unroller: a one-row layer writes the
+// rounded dot product of the row weights (from the soc memory) and the
+// activations (from spad0) to spad1, and a layer without rows finishes
+// right after the start without writing spad1.
+
+#include "test_util.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+#define TEST_WEIGHT_BASE 0x40
+#define TEST_ACT_BASE 0x200
+
+// constrain a bitvector state of the model at the start of the path
+static void SetInitVal(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                       const std::string& name, const int& val) {
+  auto s = m.state(name);
+  solver.add(unroller.CurrState(s, 0) == solver.ctx().bv_val(val, s.bit_width()));
+}
+
+static void SetLayer(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                     const int& num_rows) {
+  SetInitVal(solver, unroller, m, ACCEL_FC_CHILD_VALID_FLAG, ACCEL_FC_CHILD_VALID);
+  SetInitVal(solver, unroller, m, ACCEL_FC_CHILD_STATE, FC_CHILD_STATE_IDLE);
+  SetInitVal(solver, unroller, m, FC_WEIGHT_BASE, TEST_WEIGHT_BASE);
+  SetInitVal(solver, unroller, m, FC_ACT_BASE, TEST_ACT_BASE);
+  SetInitVal(solver, unroller, m, FC_NUM_ROWS, num_rows);
+  SetInitVal(solver, unroller, m, FC_NUM_COLS, FC_MAC_VECTOR_SIZE);
+  SetInitVal(solver, unroller, m, FC_BATCH_SIZE, 0);
+  SetInitVal(solver, unroller, m, FC_ACT_FUNC, 0);
+}
+
+static ExprRef AddrConst(const int& addr) {
+  return BvConst(addr, TOP_SLAVE_ADDR_IN_BITWIDTH);
+}
+
+bool CheckOneRow(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  std::vector<InstrRef> path = {FindInstr(m, "accel_fc_start"), FindInstr(m, "accel_fc_mac"),
+                                FindInstr(m, "accel_fc_done")};
+  solver.add(unroller.UnrollPathConn(path));
+  SetLayer(solver, unroller, m, 1);
+
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+  auto spad0 = m.state(SCRATCH_PAD_0);
+  auto spad1 = m.state(SCRATCH_PAD_1);
+
+  ExprRef psum = BvConst(0, PSUM_TOTAL_BITWIDTH);
+  for (auto i = 0; i < FC_MAC_VECTOR_SIZE; i++) {
+    auto wt = Concat(Load(vir_mem, AddrConst(TEST_WEIGHT_BASE + i)),
+                     BvConst(0, VIRTUAL_SOC_MEMORY_DATA_BITWIDTH));
+    auto act = Concat(Load(spad0, AddrConst(TEST_ACT_BASE + 2*i + 1)),
+                      Load(spad0, AddrConst(TEST_ACT_BASE + 2*i)));
+    std::vector<ExprRef> mac_in = {psum, wt, act};
+    psum = ConvMac(mac_in);
+  }
+  auto out_psum = ActAdd2Psum(ConvMacPsum2Act(psum), BvConst(0, ACT_TOTAL_BITWIDTH));
+  auto expected = unroller.GetZ3Expr(Psum2Act(out_psum), 0);
+
+  auto t_end = (int)path.size();
+  auto result = unroller.GetZ3Expr(Concat(Load(spad1, AddrConst(TEST_ACT_BASE + 1)),
+                                          Load(spad1, AddrConst(TEST_ACT_BASE))), t_end);
+  auto is_done = (unroller.CurrState(m.state(ACCEL_FC_CHILD_VALID_FLAG), t_end) ==
+                  ctx.bv_val(ACCEL_FC_CHILD_INVALID, ACCEL_FC_CHILD_VALID_FLAG_BITWIDTH));
+
+  return CheckProperty(solver, is_done && (result == expected), "one row");
+}
+
+bool CheckNoRows(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  std::vector<InstrRef> path = {FindInstr(m, "accel_fc_start"), FindInstr(m, "accel_fc_done")};
+  solver.add(unroller.UnrollPathConn(path));
+  SetLayer(solver, unroller, m, 0);
+
+  auto t_end = (int)path.size();
+  auto spad1 = m.state(SCRATCH_PAD_1);
+  auto is_done = (unroller.CurrState(m.state(ACCEL_FC_CHILD_VALID_FLAG), t_end) ==
+                  ctx.bv_val(ACCEL_FC_CHILD_INVALID, ACCEL_FC_CHILD_VALID_FLAG_BITWIDTH));
+  auto is_unchanged = (unroller.CurrState(spad1, t_end) == unroller.CurrState(spad1, 0));
+
+  return CheckProperty(solver, is_done && is_unchanged, "no rows");
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.fc_child = true;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  auto pass = true;
+  pass &= CheckOneRow(m);
+  pass &= CheckNoRows(m);
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: reduction_child_test.cc
+
+// Runs the reduction child through one 2x2 window of a 2x2x8 input map and
+// checks through the Z3 unroller that each lane of the output vector is the
+// max (or the average) of the window's four input activations of that lane,
+// and that the child is done after the window.
+
+#include "test_util.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+#define TEST_INPUT_BASE 0x0
+#define TEST_OUTPUT_BASE 0x100
+
+static ExprRef SpadAct(const ExprRef& spad, const int& addr) {
+  return Concat(Load(spad, BvConst(addr + 1, TOP_SLAVE_ADDR_IN_BITWIDTH)),
+                Load(spad, BvConst(addr, TOP_SLAVE_ADDR_IN_BITWIDTH)));
+}
+
+// constrain a bitvector state of the model at the start of the path
+static void SetInitVal(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                       const std::string& name, const int& val) {
+  auto s = m.state(name);
+  solver.add(unroller.CurrState(s, 0) == solver.ctx().bv_val(val, s.bit_width()));
+}
+
+bool CheckPool(const Ila& m, const bool& is_avg, const std::string& test_name) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  std::vector<InstrRef> path = {FindInstr(m, "accel_reduction_start")};
+  for (auto i = 0; i < 4; i++) {
+    path.push_back(FindInstr(m, "accel_reduction_accum"));
+  }
+  path.push_back(FindInstr(m, "accel_reduction_out"));
+  path.push_back(FindInstr(m, "accel_reduction_done"));
+  solver.add(unroller.UnrollPathConn(path));
+
+  SetInitVal(solver, unroller, m, ACCEL_REDUCTION_CHILD_VALID_FLAG, ACCEL_REDUCTION_CHILD_VALID);
+  SetInitVal(solver, unroller, m, ACCEL_REDUCTION_CHILD_STATE, REDUCTION_CHILD_STATE_IDLE);
+  SetInitVal(solver, unroller, m, REDUCTION_INPUT_BASE_ADDR, TEST_INPUT_BASE);
+  SetInitVal(solver, unroller, m, REDUCTION_OUTPUT_BASE_ADDR, TEST_OUTPUT_BASE);
+  SetInitVal(solver, unroller, m, REDUCTION_INPUT_ROW_NUM, 2);
+  SetInitVal(solver, unroller, m, REDUCTION_INPUT_COL_NUM, 2);
+  SetInitVal(solver, unroller, m, REDUCTION_INPUT_CHAN_NUM, CHANNEL_BLOCK_SIZE);
+  SetInitVal(solver, unroller, m, REDUCTION_POOL_SIZE, 2);
+  SetInitVal(solver, unroller, m, REDUCTION_POOL_AVG, is_avg ? 1 : 0);
+  SetInitVal(solver, unroller, m, REDUCTION_ENABLE_BIAS, 0);
+  SetInitVal(solver, unroller, m, REDUCTION_ACT_FUNC, 0);
+
+  auto spad1 = m.state(SCRATCH_PAD_1);
+  auto vec_bytes = CHANNEL_BLOCK_SIZE * (ACT_TOTAL_BITWIDTH/8);
+  auto t_end = (int)path.size();
+
+  auto prop = (unroller.CurrState(m.state(ACCEL_REDUCTION_CHILD_VALID_FLAG), t_end) ==
+               ctx.bv_val(ACCEL_REDUCTION_CHILD_INVALID, ACCEL_REDUCTION_CHILD_VALID_FLAG_BITWIDTH));
+  for (auto i = 0; i < CHANNEL_BLOCK_SIZE; i++) {
+    // the window vectors are the input vectors 0..3 in row-major order
+    auto acc = ReduceAddPsum(BvConst(0, PSUM_TOTAL_BITWIDTH),
+                             SpadAct(spad1, TEST_INPUT_BASE + 2*i));
+    for (auto k = 1; k < 4; k++) {
+      auto act = SpadAct(spad1, TEST_INPUT_BASE + k*vec_bytes + 2*i);
+      acc = is_avg ? ReduceAddPsum(acc, act) : ReduceMaxPsum(acc, act);
+    }
+    if (is_avg) {
+      acc = ReduceAvgPsum(acc, BvConst(4, REDUCTION_INPUT_BASE_ADDR_BITWIDTH));
+    }
+    auto expected = unroller.GetZ3Expr(Psum2Act(acc), 0);
+    auto result = unroller.GetZ3Expr(SpadAct(spad1, TEST_OUTPUT_BASE + 2*i), t_end);
+    prop = prop && (result == expected);
+  }
+
+  return CheckProperty(solver, prop, test_name);
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.reduction_child = true;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  auto pass = true;
+  pass &= CheckPool(m, false, "max pool");
+  pass &= CheckPool(m, true, "avg pool");
+
+  return pass ? 0 : 1;
+}
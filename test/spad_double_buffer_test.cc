@@ -0,0 +1,135 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: spad_double_buffer_test.cc
+
+// Checks the spad0 ping-pong halves through the Z3 unroller: a layer whose
+// weight base is in the upper half of spad0 sends the weights of that half to
+// the datapath, and a SPAD child beat into the lower half before that doesn't
+// change them (a beat into the upper half doesn't decode while the layer
+// runs).
+
+#include "test_util.h"
+
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+// constrain a bitvector state of the model at the start of the path
+static void SetInitVal(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                       const std::string& name, const int& val) {
+  auto s = m.state(name);
+  solver.add(unroller.CurrState(s, 0) == solver.ctx().bv_val(val, s.bit_width()));
+}
+
+// the conv child about to send the weights of filter 0 at kernel position
+// (0, 0) and channel block 0, which are at the weight base
+static void SetSendDp(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& conv) {
+  SetInitVal(solver, unroller, conv, ACCEL_CONV_CHILD_VALID_FLAG, ACCEL_CONV_CHILD_VALID);
+  SetInitVal(solver, unroller, conv, ACCEL_CONV_CHILD_STATE, CONV_CHILD_STATE_WEIGHT_SEND_DP);
+  SetInitVal(solver, unroller, conv, CONV_WEIGHT_BASE, SPAD_HALF_BYTE_NUM);
+  SetInitVal(solver, unroller, conv, SPAD0_CONV_HALF, 1);
+  SetInitVal(solver, unroller, conv, CONV_CHILD_FILTER_ID, 0);
+  SetInitVal(solver, unroller, conv, CONV_CHILD_KERNEL_ROW_ID, 0);
+  SetInitVal(solver, unroller, conv, CONV_CHILD_KERNEL_COL_ID, 0);
+  SetInitVal(solver, unroller, conv, CONV_CHILD_CHAN_BLOCK_ID, 0);
+}
+
+bool CheckUpperHalf(const Ila& m, const int& lanes) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  std::vector<InstrRef> path = {FindInstr(m, "accel_conv_send_dp")};
+  solver.add(unroller.UnrollPathConn(path));
+  auto conv = m.child("Accel_Conv_Child");
+  SetSendDp(solver, unroller, conv);
+
+  auto spad0 = m.state(SCRATCH_PAD_0);
+  auto t_end = (int)path.size();
+  auto prop = ctx.bool_val(true);
+  for (auto i = 0; i < lanes; i++) {
+    auto wt_byte = Load(spad0, BvConst(SPAD_HALF_BYTE_NUM + i, TOP_SLAVE_ADDR_IN_BITWIDTH));
+    auto expected = unroller.GetZ3Expr(Concat(wt_byte, BvConst(0, SCRATCH_PAD_DATA_BITWIDTH)), 0);
+    auto wt = conv.state(GetStateName(CONV_CHILD_WEIGHT_ARRAY, i));
+    prop = prop && (unroller.CurrState(wt, t_end) == expected);
+  }
+
+  return CheckProperty(solver, prop, "upper half");
+}
+
+bool CheckLowerHalfDma(const Ila& m, const int& lanes) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller_a(ctx, "_a");
+  IlaZ3Unroller unroller_b(ctx, "_b");
+
+  // path a has a SPAD child beat into spad0 before the weights are sent
+  auto send_dp = FindInstr(m, "accel_conv_send_dp");
+  std::vector<InstrRef> path_a = {FindInstr(m, "spad_0_child_wr"), send_dp};
+  std::vector<InstrRef> path_b = {send_dp};
+  solver.add(unroller_a.UnrollPathConn(path_a));
+  solver.add(unroller_b.UnrollPathConn(path_b));
+
+  std::vector<ExprRef> states;
+  CollectStates(m, states);
+  for (auto& s : states) {
+    solver.add(unroller_a.CurrState(s, 0) == unroller_b.CurrState(s, 0));
+  }
+  auto conv = m.child("Accel_Conv_Child");
+  SetSendDp(solver, unroller_a, conv);
+  SetInitVal(solver, unroller_a, m, SPAD_RD_WR_CNTR, 0);
+
+  // the beat is in the lower half of spad0
+  auto addr_in = unroller_a.CurrState(m.input(TOP_SLAVE_ADDR_IN), 0);
+  solver.add(z3::uge(addr_in, ctx.bv_val(SPAD0_BASE_ADDR, TOP_SLAVE_ADDR_IN_BITWIDTH)));
+  solver.add(z3::ule(addr_in, ctx.bv_val(SPAD0_BASE_ADDR + SPAD_HALF_BYTE_NUM - 16,
+                                         TOP_SLAVE_ADDR_IN_BITWIDTH)));
+
+  auto prop = ctx.bool_val(true);
+  for (auto i = 0; i < lanes; i++) {
+    auto wt = conv.state(GetStateName(CONV_CHILD_WEIGHT_ARRAY, i));
+    prop = prop && (unroller_a.CurrState(wt, (int)path_a.size()) ==
+                    unroller_b.CurrState(wt, (int)path_b.size()));
+  }
+
+  return CheckProperty(solver, prop, "lower half dma");
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.spad_double_buffer = true;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  auto pass = true;
+  pass &= CheckUpperHalf(m, cfg.conv_lanes);
+  pass &= CheckLowerHalfDma(m, cfg.conv_lanes);
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: spad_wb_child_test.cc
+
+// Checks the spad1 write-back child through the Z3 unroller: the lines of a
+// region are copied from spad1 to the soc memory and the child stops after
+// the last one, a host write to AccelSpadCFG starts it on that spad1 offset,
+// and it doesn't start on an empty region.
+
+#include "test_util.h"
+
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+using namespace ilang;
+using namespace ilang::hlscnn;
+
+#define TEST_SPAD_ADDR 0x20
+#define TEST_SOC_ADDR 0x100
+#define TEST_LINE_BYTES 16
+
+// constrain a bitvector state of the model at the start of the path
+static void SetInitVal(z3::solver& solver, IlaZ3Unroller& unroller, const Ila& m,
+                       const std::string& name, const int& val) {
+  auto s = m.state(name);
+  solver.add(unroller.CurrState(s, 0) == solver.ctx().bv_val(val, s.bit_width()));
+}
+
+// byte at addr (a TOP_SLAVE_ADDR_IN_BITWIDTH-bit z3 expr) of mem after step t
+static z3::expr MemByte(IlaZ3Unroller& unroller, const ExprRef& mem, const int& t,
+                        const z3::expr& addr) {
+  return z3::select(unroller.CurrState(mem, t), addr);
+}
+
+static z3::expr IsStopped(z3::context& ctx, IlaZ3Unroller& unroller, const Ila& m,
+                          const int& t) {
+  return unroller.CurrState(m.state(SPAD_WB_CHILD_VALID_FLAG), t) ==
+         ctx.bv_val(0, SPAD_WB_CHILD_VALID_FLAG_BITWIDTH);
+}
+
+bool CheckLines(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  auto wb = FindInstr(m, "spad_1_child_wb");
+  std::vector<InstrRef> path = {wb, wb};
+  solver.add(unroller.UnrollPathConn(path));
+  SetInitVal(solver, unroller, m, SPAD_WB_CHILD_VALID_FLAG, 1);
+  SetInitVal(solver, unroller, m, SPAD_WB_CNTR, 0);
+  SetInitVal(solver, unroller, m, SPAD_WB_SPAD_ADDR, TEST_SPAD_ADDR);
+  SetInitVal(solver, unroller, m, SPAD_WB_SOC_ADDR, TEST_SOC_ADDR);
+  SetInitVal(solver, unroller, m, SPAD_WB_LENGTH, 2);
+
+  auto t_end = (int)path.size();
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+  auto spad1 = m.state(SCRATCH_PAD_1);
+
+  auto prop = IsStopped(ctx, unroller, m, t_end);
+  for (auto i = 0; i < 2 * TEST_LINE_BYTES; i++) {
+    auto soc_addr = ctx.bv_val(TEST_SOC_ADDR + i, TOP_SLAVE_ADDR_IN_BITWIDTH);
+    auto spad_addr = ctx.bv_val(TEST_SPAD_ADDR + i, TOP_SLAVE_ADDR_IN_BITWIDTH);
+    prop = prop && (MemByte(unroller, vir_mem, t_end, soc_addr) ==
+                    MemByte(unroller, spad1, 0, spad_addr));
+  }
+  // the byte after the region is left as it was
+  auto after_addr = ctx.bv_val(TEST_SOC_ADDR + 2 * TEST_LINE_BYTES, TOP_SLAVE_ADDR_IN_BITWIDTH);
+  prop = prop && (MemByte(unroller, vir_mem, t_end, after_addr) ==
+                  MemByte(unroller, vir_mem, 0, after_addr));
+
+  return CheckProperty(solver, prop, "two lines");
+}
+
+bool CheckHostStart(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  std::vector<InstrRef> path = {FindInstr(m, "CFG_REG_WR_ACCEL_SPAD_CFG"),
+                                FindInstr(m, "spad_1_child_wb")};
+  solver.add(unroller.UnrollPathConn(path));
+  SetInitVal(solver, unroller, m, SPAD_WB_CHILD_VALID_FLAG, 0);
+  SetInitVal(solver, unroller, m, CFG_REG_SOC_MEM_BASE_ADDR, TEST_SOC_ADDR);
+  SetInitVal(solver, unroller, m, CFG_REG_SOC_MEM_RD_WR_LENGTH, 1);
+
+  auto t_end = (int)path.size();
+  auto vir_mem = m.state(VIRTUAL_SOC_MEMORY);
+  auto spad1 = m.state(SCRATCH_PAD_1);
+  // the spad1 offset written by the host
+  auto spad_base = unroller.CurrState(m.state(CFG_REG_ACCEL_SPAD_CFG), 1);
+
+  auto prop = IsStopped(ctx, unroller, m, t_end);
+  for (auto i = 0; i < TEST_LINE_BYTES; i++) {
+    auto soc_addr = ctx.bv_val(TEST_SOC_ADDR + i, TOP_SLAVE_ADDR_IN_BITWIDTH);
+    auto spad_addr = spad_base + ctx.bv_val(i, TOP_SLAVE_ADDR_IN_BITWIDTH);
+    prop = prop && (MemByte(unroller, vir_mem, t_end, soc_addr) ==
+                    MemByte(unroller, spad1, 0, spad_addr));
+  }
+
+  return CheckProperty(solver, prop, "host start");
+}
+
+bool CheckEmptyRegion(const Ila& m) {
+  z3::context ctx;
+  z3::solver solver(ctx);
+  IlaZ3Unroller unroller(ctx, "_0");
+
+  std::vector<InstrRef> path = {FindInstr(m, "CFG_REG_WR_ACCEL_SPAD_CFG")};
+  solver.add(unroller.UnrollPathConn(path));
+  SetInitVal(solver, unroller, m, SPAD_WB_CHILD_VALID_FLAG, 0);
+  SetInitVal(solver, unroller, m, CFG_REG_SOC_MEM_RD_WR_LENGTH, 0);
+
+  return CheckProperty(solver, IsStopped(ctx, unroller, m, (int)path.size()), "empty region");
+}
+
+int main() {
+  SetToStdErr(1);
+
+  ModelConfig cfg;
+  cfg.spad_write_back = true;
+  auto m = GetHlscnnIla("hlscnn", cfg);
+
+  auto pass = true;
+  pass &= CheckLines(m);
+  pass &= CheckHostStart(m);
+  pass &= CheckEmptyRegion(m);
+
+  return pass ? 0 : 1;
+}
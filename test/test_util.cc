@@ -0,0 +1,86 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: test_util.cc
+
+#include "test_util.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace ilang {
+namespace hlscnn {
+
+static bool FindInstrRec(const Ila& m, const std::string& name, InstrRef& found) {
+  for (auto i = 0; i < m.instr_num(); i++) {
+    if (m.instr(i).name() == name) {
+      found = m.instr(i);
+      return true;
+    }
+  }
+  for (auto i = 0; i < m.child_num(); i++) {
+    if (FindInstrRec(m.child(i), name, found)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+InstrRef FindInstr(const Ila& m, const std::string& name) {
+  auto found = m.instr(0);
+  if (!FindInstrRec(m, name, found)) {
+    std::cerr << "instr " << name << " not found" << std::endl;
+    std::exit(1);
+  }
+  return found;
+}
+
+void CollectStates(const Ila& m, std::vector<ExprRef>& states) {
+  for (auto i = 0; i < m.state_num(); i++) {
+    states.push_back(m.state(i));
+  }
+  for (auto i = 0; i < m.child_num(); i++) {
+    CollectStates(m.child(i), states);
+  }
+}
+
+bool CheckProperty(z3::solver& solver, const z3::expr& prop, const std::string& test_name) {
+  // the path must be feasible, otherwise the property holds vacuously
+  if (solver.check() != z3::sat) {
+    std::cerr << test_name << ": path not feasible" << std::endl;
+    return false;
+  }
+  solver.push();
+  solver.add(!prop);
+  auto res = solver.check();
+  solver.pop();
+  if (res != z3::unsat) {
+    std::cerr << test_name << ": property does not hold" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace hlscnn
+} // namespace ilang
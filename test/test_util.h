@@ -0,0 +1,56 @@
+// =============================================================================
+// MIT License
+//
+// Copyright (c) 2019 Princeton University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+
+// File: test_util.h
+
+// Helpers shared by the model tests, which check instruction paths of the
+// model through the Z3 unroller.
+
+#ifndef HLSCNN_TEST_UTIL_H__
+#define HLSCNN_TEST_UTIL_H__
+
+#include <hlscnn/hlscnn_top.h>
+
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+namespace ilang {
+namespace hlscnn {
+
+// find an instruction of the model or of its (nested) children by name; the
+// test fails (exits with 1) if there is no such instruction
+InstrRef FindInstr(const Ila& m, const std::string& name);
+
+// collect the states of the model and of all its children
+void CollectStates(const Ila& m, std::vector<ExprRef>& states);
+
+// check that the constraints added to the solver are satisfiable (so the check
+// is not vacuous) and that prop holds under all of them
+bool CheckProperty(z3::solver& solver, const z3::expr& prop, const std::string& test_name);
+
+} // namespace hlscnn
+} // namespace ilang
+
+#endif // HLSCNN_TEST_UTIL_H__
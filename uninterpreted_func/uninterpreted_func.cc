@@ -5,6 +5,7 @@
 #include <ac_math.h>
 
 #include <common.h>
+#include <map>
 
 // conv_accel.h:799
 // multiply-accumulate operation
@@ -125,3 +126,241 @@ sc_biguint<16> hlscnn::Psum2Act(sc_biguint<32> arg_0) {
 
   return out;
 }
+
+// reduction: max of the psum so far and an activation
+sc_biguint<32> hlscnn::ReduceMaxPsum(sc_biguint<32> psum, sc_biguint<16> act) {
+  ac_int<32, false> psum_ac = psum.to_uint();
+  ac_int<16, false> act_ac = act.to_uint();
+
+  conv_psum_t psum_op, out_psum;
+  conv_activation_t act_op;
+  psum_op.set_slc<32>(0, psum_ac);
+  act_op.set_slc<16>(0, act_ac);
+  out_psum = (conv_psum_t(act_op) > psum_op) ? conv_psum_t(act_op) : psum_op;
+
+  ac_int<32, false> out_ac = out_psum.slc<32>(0);
+  sc_biguint<32> out = out_ac.to_uint();
+  return out;
+}
+
+// reduction: add an activation to the psum so far
+sc_biguint<32> hlscnn::ReduceAddPsum(sc_biguint<32> psum, sc_biguint<16> act) {
+  ac_int<32, false> psum_ac = psum.to_uint();
+  ac_int<16, false> act_ac = act.to_uint();
+
+  conv_psum_t psum_op, out_psum;
+  conv_activation_t act_op;
+  psum_op.set_slc<32>(0, psum_ac);
+  act_op.set_slc<16>(0, act_ac);
+  out_psum = psum_op + act_op;
+
+  ac_int<32, false> out_ac = out_psum.slc<32>(0);
+  sc_biguint<32> out = out_ac.to_uint();
+  return out;
+}
+
+// reduction: average of the window sum, rounded towards -inf like the
+// truncating psum type. Dividing the fixed-point psum by an integer count only
+// divides its raw bits: power-of-two windows (2x2, 4x4, ...) take an arithmetic
+// shift, the others a division with the remainder of negative sums rounded down.
+sc_biguint<32> hlscnn::ReduceAvgPsum(sc_biguint<32> psum, sc_biguint<32> count) {
+  ac_int<32, true> psum_raw = psum.to_int();
+  unsigned cnt = count.to_uint();
+
+  ac_int<32, true> out_raw = psum_raw;
+  if ((cnt != 0) && ((cnt & (cnt - 1)) == 0)) {
+    int shift = 0;
+    while ((1u << shift) != cnt) {
+      shift++;
+    }
+    out_raw = psum_raw >> shift;
+  } else if (cnt != 0) {
+    ac_int<32, true> cnt_ac = cnt;
+    out_raw = psum_raw / cnt_ac;
+    if ((psum_raw < 0) && (out_raw * cnt_ac != psum_raw)) {
+      out_raw = out_raw - 1;
+    }
+  }
+
+  ac_int<32, false> out_ac = out_raw;
+  sc_biguint<32> out = out_ac.to_uint();
+  return out;
+}
+
+// relu clipped at the threshold, which is given in the low bits of the psum type
+sc_biguint<32> hlscnn::PsumReluThreshold(sc_biguint<32> arg_0, sc_biguint<22> threshold) {
+  ac_int<32, false> arg_0_ac = arg_0.to_uint();
+  ac_int<22, false> threshold_ac = threshold.to_uint();
+
+  conv_psum_t arg_0_psum, threshold_psum, out_psum;
+  arg_0_psum.set_slc<32>(0, arg_0_ac);
+  threshold_psum = conv_psum_t(0);
+  threshold_psum.set_slc<22>(0, threshold_ac);
+  out_psum = (arg_0_psum > 0) ? arg_0_psum : conv_psum_t(0);
+  out_psum = (out_psum > threshold_psum) ? threshold_psum : out_psum;
+
+  ac_int<32, false> out_ac = out_psum.slc<32>(0);
+  sc_biguint<32> out = out_ac.to_uint();
+  return out;
+}
+
+// layer-level conv: this replays the loops of the fine-grained conv child
+// (filter -> channel block -> input row -> input col -> kernel row -> kernel col)
+// with the same address generation and fixed-point functions as above, thus
+// the returned spad1 is the same as running Accel_Conv_Child to the end.
+static int LoadMem(const std::map<int, int>& mem, unsigned addr) {
+  auto it = mem.find((int)addr);
+  return (it == mem.end()) ? 0 : it->second;
+}
+
+std::map<int, int> hlscnn::ConvLayer(std::map<int, int> vir_mem,
+                                     std::map<int, int> spad0,
+                                     std::map<int, int> spad1,
+                                     sc_biguint<32> act_base,
+                                     sc_biguint<10> input_rows,
+                                     sc_biguint<10> input_cols,
+                                     sc_biguint<12> input_chans,
+                                     sc_biguint<8> kernel_rows,
+                                     sc_biguint<8> kernel_cols,
+                                     sc_biguint<8> r_stride,
+                                     sc_biguint<8> c_stride,
+                                     sc_biguint<16> chan_bias,
+                                     sc_biguint<1> en_bias,
+                                     sc_biguint<1> en_relu,
+                                     sc_biguint<1> en_accum,
+                                     sc_biguint<8> ofilter_idx) {
+  // the masks are the bitwidths of the loop states in the conv child
+  const unsigned row_mask = 0x7ff;    // CONV_ROW_SIZE_T
+  const unsigned chan_mask = 0x1fff;  // CONV_CHANNEL_SIZE_T
+  const unsigned kern_mask = 0x1ff;   // CONV_KERNEL_SIZE_T
+  const unsigned filter_mask = 0x1ff; // CONV_FILTER_SIZE_T
+
+  unsigned base = act_base.to_uint();
+  unsigned rows = input_rows.to_uint();
+  unsigned cols = input_cols.to_uint();
+  unsigned chans = input_chans.to_uint();
+  unsigned k_rows = kernel_rows.to_uint();
+  unsigned k_cols = kernel_cols.to_uint();
+  unsigned rs = r_stride.to_uint();
+  unsigned cs = c_stride.to_uint();
+  unsigned num_filters = ofilter_idx.to_uint();
+
+  unsigned last_chan_block = (chans % 8 == 0) ? chans / 8 : chans / 8 + 1;
+  unsigned wbact_idx = ((num_filters - 1) & 0xff) % 8;
+
+  for (unsigned filter = 0; ; filter++) {
+    for (unsigned chan_block = 0; ; chan_block++) {
+      for (unsigned in_row = 0; ; in_row++) {
+        unsigned col_loop = 0;
+        while (true) {
+          unsigned col_remain = (cols - col_loop) & row_mask;
+          unsigned req_len = (col_remain > 8) ? 8 : col_remain;
+          for (unsigned cntr = 0; ; cntr++) {
+            unsigned in_col = (col_loop + cntr) & row_mask;
+            unsigned kr_init = in_row % rs;
+            unsigned kc_init = in_col % cs;
+            unsigned act_addr = base + ((chan_block * rows * cols * 8) +
+                                        in_row * (cols * 8) + in_col * 8) * 2;
+
+            for (unsigned kr = kr_init; ; kr = (kr + rs) & kern_mask) {
+              for (unsigned kc = kc_init; ; kc = (kc + cs) & kern_mask) {
+                // conv_out_of_bound
+                unsigned out_row = (in_row + k_rows / 2 - kr) & row_mask;
+                unsigned out_col = (in_col + k_cols / 2 - kc) & row_mask;
+                bool out_of_bound = (out_row >= rows) || (out_col >= cols) ||
+                                    (in_row + k_rows / 2 < kr) ||
+                                    (in_col + k_cols / 2 < kc) ||
+                                    (kr >= k_rows) || (kc >= k_cols);
+                if (!out_of_bound) {
+                  // accel_conv_send_dp and conv_child_dp_mac_psum
+                  unsigned wt_addr = ((filter * k_rows * k_cols * last_chan_block * 8) +
+                                      (chan_block * k_rows * k_cols * 8) +
+                                      kr * (k_cols * 8) + kc * 8) * 2 / 16 * 8;
+                  sc_biguint<32> mac_psum = 0;
+                  for (unsigned i = 0; i < 8; i++) {
+                    sc_biguint<16> wt = LoadMem(spad0, wt_addr + i) << 8;
+                    sc_biguint<16> act = (LoadMem(vir_mem, act_addr + 2*i + 1) << 8) |
+                                         LoadMem(vir_mem, act_addr + 2*i);
+                    mac_psum = ConvMac(mac_psum, wt, act);
+                  }
+                  sc_biguint<16> psum_val = ConvMacPsum2Act(mac_psum);
+
+                  // conv_child_fetch_act_spad1 and conv_child_dp_bias_relu
+                  unsigned out_addr = ((filter * rows * cols * 8) + out_row * (cols * 8) +
+                                       out_col * 8) * 2 / 16 * 16;
+                  sc_biguint<16> oact = (LoadMem(spad1, out_addr + 2*wbact_idx + 1) << 8) |
+                                        LoadMem(spad1, out_addr + 2*wbact_idx);
+                  bool is_first = (kr == 0) && (kc == 0) && (chan_block == 0);
+                  bool is_last = (kr == k_rows - 1) && (kc == k_cols - 1) &&
+                                 (chan_block == ((last_chan_block - 1) & chan_mask));
+
+                  sc_biguint<32> oact_out = (is_first && en_accum == 0) ?
+                                            ActAdd2Psum(psum_val, 0) :
+                                            ActAdd2Psum(psum_val, oact);
+                  if (is_last && en_bias != 0) {
+                    oact_out = ConvAddBias(oact_out, chan_bias);
+                  }
+                  if (is_last && en_relu != 0) {
+                    oact_out = PsumRelu(oact_out);
+                  }
+                  unsigned out_act = Psum2Act(oact_out).to_uint();
+
+                  // conv_child_output, the other lanes of out_array are zero
+                  for (unsigned i = 0; i < 8; i++) {
+                    unsigned val = (i == wbact_idx) ? out_act : 0;
+                    spad1[(int)(out_addr + 2*i)] = val & 0xff;
+                    spad1[(int)(out_addr + 2*i + 1)] = (val >> 8) & 0xff;
+                  }
+                }
+                if (kc + cs >= k_cols) break;
+              }
+              if (kr + rs >= k_rows) break;
+            }
+            if (cntr >= ((req_len - 1) & row_mask)) break;
+          }
+          if (col_loop >= ((cols - req_len) & row_mask)) break;
+          col_loop += req_len;
+        }
+        if (in_row >= ((rows - 1) & row_mask)) break;
+      }
+      if (chan_block >= ((last_chan_block - 1) & chan_mask)) break;
+    }
+    if (filter >= ((num_filters - 1) & filter_mask)) break;
+  }
+
+  return spad1;
+}
+
+// bulk copy of the SPAD child (soc memory -> spad) and of the spad1 write-back
+// child (spad1 -> soc memory): same bytes as the per-16-byte instructions;
+// bytes never written to src_mem are read as zero
+std::map<int, int> hlscnn::SpadBulkCopy(std::map<int, int> dst_mem,
+                                        std::map<int, int> src_mem,
+                                        sc_biguint<32> dst_addr,
+                                        sc_biguint<32> src_addr,
+                                        sc_biguint<32> num_bytes) {
+  unsigned dst = dst_addr.to_uint();
+  unsigned src = src_addr.to_uint();
+  unsigned num = num_bytes.to_uint();
+  for (unsigned i = 0; i < num; i++) {
+    dst_mem[(int)(dst + i)] = LoadMem(src_mem, src + i);
+  }
+  return dst_mem;
+}
+
+// bulk spad readback: same elements as repeating SPAD*_DATA_RD over the range
+std::map<int, int> hlscnn::SpadBulkRead(std::map<int, int> out_mem,
+                                        std::map<int, int> spad,
+                                        sc_biguint<32> out_addr,
+                                        sc_biguint<32> spad_addr,
+                                        sc_biguint<32> num_elems) {
+  unsigned dst = out_addr.to_uint();
+  unsigned src = spad_addr.to_uint();
+  unsigned num = num_elems.to_uint();
+  for (unsigned i = 0; i < num; i++) {
+    int byte_0 = LoadMem(spad, src + 2*i);
+    int byte_1 = LoadMem(spad, src + 2*i + 1);
+    out_mem[(int)(dst + 2*i)] = (byte_1 << 8) | byte_0;
+  }
+  return out_mem;
+}
@@ -1,5 +1,6 @@
 #include <hlscnn.h>
 #include <systemc.h>
+#include <map>
 
 // conv_accel.h:799
 // multiply-accumulate operation
@@ -50,3 +51,62 @@ sc_biguint<16> hlscnn::Psum2Act(sc_biguint<32> arg_0) {
 
   return out;
 }
+
+// reduction functions
+sc_biguint<32> hlscnn::ReduceMaxPsum(sc_biguint<32> psum, sc_biguint<16> act) {
+  sc_biguint<32> out = 1;
+  return out;
+}
+
+sc_biguint<32> hlscnn::ReduceAddPsum(sc_biguint<32> psum, sc_biguint<16> act) {
+  sc_biguint<32> out = 1;
+  return out;
+}
+
+sc_biguint<32> hlscnn::ReduceAvgPsum(sc_biguint<32> psum, sc_biguint<32> count) {
+  sc_biguint<32> out = 1;
+  return out;
+}
+
+sc_biguint<32> hlscnn::PsumReluThreshold(sc_biguint<32> arg_0, sc_biguint<22> threshold) {
+  sc_biguint<32> out = 1;
+  return out;
+}
+
+// layer-level conv
+std::map<int, int> hlscnn::ConvLayer(std::map<int, int> vir_mem,
+                                     std::map<int, int> spad0,
+                                     std::map<int, int> spad1,
+                                     sc_biguint<32> act_base,
+                                     sc_biguint<10> input_rows,
+                                     sc_biguint<10> input_cols,
+                                     sc_biguint<12> input_chans,
+                                     sc_biguint<8> kernel_rows,
+                                     sc_biguint<8> kernel_cols,
+                                     sc_biguint<8> r_stride,
+                                     sc_biguint<8> c_stride,
+                                     sc_biguint<16> chan_bias,
+                                     sc_biguint<1> en_bias,
+                                     sc_biguint<1> en_relu,
+                                     sc_biguint<1> en_accum,
+                                     sc_biguint<8> ofilter_idx) {
+  return spad1;
+}
+
+// bulk copy of the SPAD child
+std::map<int, int> hlscnn::SpadBulkCopy(std::map<int, int> dst_mem,
+                                        std::map<int, int> src_mem,
+                                        sc_biguint<32> dst_addr,
+                                        sc_biguint<32> src_addr,
+                                        sc_biguint<32> num_bytes) {
+  return dst_mem;
+}
+
+// bulk spad readback
+std::map<int, int> hlscnn::SpadBulkRead(std::map<int, int> out_mem,
+                                        std::map<int, int> spad,
+                                        sc_biguint<32> out_addr,
+                                        sc_biguint<32> spad_addr,
+                                        sc_biguint<32> num_elems) {
+  return out_mem;
+}